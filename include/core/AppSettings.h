@@ -15,6 +15,10 @@ struct AppSettings {
     bool save_logs = true;
     QString log_level = "info";
     QString log_path = "";
+    // Rotation of the log file; rotated segments are kept gzip-compressed.
+    int log_rotate_mb = 10;     // 0 = no size limit
+    int log_rotate_hours = 24;  // 0 = no age limit
+    int log_generations = 5;    // compressed archives kept
     QString theme_mode = "system";
     QString language = "en";
     bool auto_connect_on_start = false;
@@ -25,11 +29,22 @@ struct AppSettings {
     bool notify_only_errors = false;
     bool killswitch_enabled = false;
     bool strict_certificate_check = true;
+    // Race all endpoint.addresses before connecting and try the fastest first.
+    bool endpoint_probe_enabled = true;
+    bool endpoint_probe_tls = false; // time the TLS handshake too, not just TCP connect
+    // Planned reconnects prepare and handshake-check the replacement before dropping the old session.
+    bool make_before_break = false;
     bool first_run_checked = false;
     bool routing_enabled = false;
     QString routing_mode = "tunnel_ru"; // tunnel_ru | bypass_ru
     QString routing_cache_path = "";
     QString routing_source_url = "https://antifilter.download/list/subnet.lst";
+    // Upper bound on routes handed to the core; 0 = exact list (lossless merge only).
+    // When exceeded, prefixes are widened into supernets until the list fits.
+    // tunnel_ru only: bypass routes are never widened.
+    int routing_max_routes = 0;
+    // Background refresh period for the routing list; 0 = only when missing.
+    int routing_refresh_hours = 24;
 
     // Custom DNS servers (override config dns_upstreams when non-empty)
     bool custom_dns_enabled = false;
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QString>
+#include <memory>
+
+#include <toml++/toml.h>
+
+/// A config file parsed once and shared by everything that reads it.
+struct ParsedConfig {
+    std::shared_ptr<const toml::table> table; ///< null if the file could not be read or parsed
+    QString error;                            ///< parse error description when `table` is null
+
+    // Display metadata, derived once at parse time.
+    QString hostname; ///< endpoint.hostname
+    QString port;     ///< port of the first endpoint.addresses entry
+    QString protocol; ///< endpoint.upstream_protocol, upper-cased
+};
+
+/**
+ * Returns the parsed config at `path`.
+ *
+ * Entries are keyed by canonical path and re-parsed only when the file's
+ * mtime or size changes, so reconnects and UI refreshes cost a stat() rather
+ * than a read and a TOML parse. The returned table is immutable; callers
+ * that need to edit it (endpoint ranking) copy it first. Thread-safe.
+ */
+std::shared_ptr<const ParsedConfig> parsedConfig(const QString &path);
+
+/// Drops the cached entry so the next parsedConfig() re-reads the file.
+void invalidateParsedConfig(const QString &path);
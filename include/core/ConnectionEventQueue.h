@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <cstddef>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "BoundedMpmcQueue.h"
+
+/// Final routing decision the core made for a flow.
+enum class FlowAction : quint8 {
+    Unknown,
+    Bypass,
+    Tunnel,
+    Reject,
+};
+
+QString flowActionName(FlowAction action);
+
+/// Compact record written by core threads for every new TCP/UDP flow.
+struct ConnectionEvent {
+    quint64 connectionId = 0; ///< core's per-flow id, joins with FlowStatsEvent
+    qint64 timestampMs = 0;   ///< wall clock, ms since epoch
+    quint32 domainId = 0;     ///< id from ConnectionEventQueue::domainName()
+    FlowAction action = FlowAction::Unknown;
+    quint16 generation = 0;   ///< resetDomains() count when pushed; stale events are dropped by drain()
+};
+
+/// Per-connection byte delta reported by the core's tunnel_stats callback.
+struct FlowStatsEvent {
+    quint64 connectionId = 0;
+    quint64 upload = 0;
+    quint64 download = 0;
+};
+
+/// Bounded, lock-free hand-off of connection_info events from the core's
+/// threads to the GUI. Producers push fixed-size records (domains are
+/// interned to small ids) and never allocate on the fast path; the GUI
+/// drains in batches on a timer. When the ring is full the event is counted
+/// as dropped instead of growing an unbounded Qt event queue.
+class ConnectionEventQueue {
+public:
+    static constexpr quint32 kNoDomainId = 0;       ///< event had no domain
+    static constexpr quint32 kOverflowDomainId = 1; ///< interner is full
+
+    explicit ConnectionEventQueue(std::size_t capacity = 4096, std::size_t maxDomains = 16384);
+
+    /// Called from core threads. Returns false (and counts a drop) if the ring is full.
+    bool push(quint64 connectionId, FlowAction action, const char *domain);
+    bool pushStats(quint64 connectionId, quint64 upload, quint64 download);
+
+    /// Moves up to `max` queued events into `out` (appending). GUI thread only.
+    /// Events pushed before the last resetDomains() are discarded.
+    std::size_t drain(std::vector<ConnectionEvent> &out, std::size_t max = 1024);
+    std::size_t drainStats(std::vector<FlowStatsEvent> &out, std::size_t max = 4096);
+
+    /// Total events dropped because the ring was full.
+    quint64 droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+    quint64 droppedStatsCount() const { return m_droppedStats.load(std::memory_order_relaxed); }
+
+    QString domainName(quint32 id) const;
+    /// Forgets every interned domain so a new session starts with the full
+    /// id budget. Call between sessions, after draining. Producers of the
+    /// previous session may still be pushing; their events carry the old
+    /// generation and never reach drain()'s output.
+    void resetDomains();
+
+private:
+    struct StringHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view sv) const { return std::hash<std::string_view>{}(sv); }
+    };
+
+    quint32 intern(const char *domain, quint16 &generation);
+
+    BoundedMpmcQueue<ConnectionEvent> m_ring;
+    BoundedMpmcQueue<FlowStatsEvent> m_statsRing;
+    std::atomic<quint64> m_dropped{0};
+    std::atomic<quint64> m_droppedStats{0};
+
+    const std::size_t m_maxDomains;
+    mutable std::shared_mutex m_domainsMutex;
+    std::atomic<quint16> m_generation{0}; // bumped under m_domainsMutex, read with the ids it covers
+    std::unordered_map<std::string, quint32, StringHash, std::equal_to<>> m_domainIds;
+    std::vector<std::string> m_domainNames;
+};
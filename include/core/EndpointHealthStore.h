@@ -0,0 +1,83 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <mutex>
+#include <vector>
+
+#include "EndpointProber.h"
+
+/**
+ * Per-endpoint connection history, persisted next to configs.json.
+ *
+ * Keeps exponentially weighted averages rather than raw samples, so the file
+ * stays a few hundred bytes per endpoint no matter how long it runs. Used to
+ * order endpoint.addresses before each connect: recently failing or
+ * short-lived endpoints sink. Parking an endpoint that keeps failing is left
+ * to ReconnectPolicy's circuit breakers.
+ *
+ * Writes are coalesced: a change is saved at once only if the last save
+ * is at least kSaveIntervalMs old, otherwise it waits for the next record
+ * or flush(), so a probe round over N endpoints is not N file rewrites.
+ *
+ * Thread-safe: probes are recorded from the connect thread, session events
+ * from the GUI thread.
+ */
+class EndpointHealthStore {
+public:
+    struct Entry {
+        double latencyMs = -1;        ///< EWMA of probe RTT, -1 if unknown
+        double connectMs = -1;        ///< EWMA of full connect + handshake time, -1 if unknown
+        double failureRate = 0;       ///< EWMA of failed attempts (short sessions count as failures)
+        double sessionSecs = -1;      ///< EWMA of session lifetime, -1 if unknown
+        quint32 attempts = 0;
+        quint32 failures = 0;
+        quint32 consecutiveFailures = 0;
+        qint64 lastSuccessMs = 0;     ///< wall clock, ms since epoch
+        qint64 lastFailureMs = 0;
+        QString lastReason;           ///< last failure or reconnect reason
+    };
+
+    static constexpr qint64 kSaveIntervalMs = 10 * 1000;
+
+    explicit EndpointHealthStore(QString path = defaultPath());
+    ~EndpointHealthStore(); // flush()
+
+    EndpointHealthStore(const EndpointHealthStore &) = delete;
+    EndpointHealthStore &operator=(const EndpointHealthStore &) = delete;
+
+    static QString defaultPath();
+
+    void recordProbe(const QString &address, bool reachable, qint64 rttMs);
+    void recordConnected(const QString &address, qint64 connectMs);
+    void recordFailure(const QString &address, const QString &reason);
+    /// `failure` marks sessions that ended on an error rather than a user disconnect.
+    void recordSessionEnd(const QString &address, qint64 lifetimeSecs, const QString &reason, bool failure);
+
+    /// Orders addresses best-first. Probe results, when given, take priority
+    /// for reachability and latency; history breaks ties and demotes flaky
+    /// endpoints. Latency is compared on probe RTT only: connect time
+    /// includes the handshake and is not on the same scale.
+    QStringList rank(const QStringList &addresses, const std::vector<EndpointProbeResult> &probe = {}) const;
+
+    Entry entry(const QString &address) const;
+
+    /// Writes changes still waiting for the save interval, e.g. at shutdown.
+    void flush();
+
+private:
+    static QString normalize(const QString &address) { return address.trimmed(); }
+    double scoreLocked(const QString &address, qint64 probeRttMs) const;
+    void failLocked(Entry &e, const QString &reason, qint64 nowMs);
+    void load();
+    void changedLocked(qint64 nowMs);
+    void saveLocked(qint64 nowMs);
+
+    const QString m_path;
+    mutable std::mutex m_mutex;
+    QHash<QString, Entry> m_entries;
+    bool m_dirty = false;
+    qint64 m_lastSaveMs = 0;
+};
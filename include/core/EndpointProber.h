@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <vector>
+
+/// Splits "host:port", "[v6]:port" (optionally "|"-prefixed) endpoint addresses.
+bool splitHostPort(QString s, QString *host, quint16 *port);
+
+struct EndpointProbeResult {
+    QString address;      ///< entry as written in endpoint.addresses
+    bool reachable = false;
+    qint64 rttMs = -1;    ///< TCP connect (or TCP+TLS handshake) time
+    QString error;
+};
+
+/**
+ * Races connection attempts to every endpoint address and ranks them by RTT.
+ *
+ * Attempts start in address order, staggered by a few tens of ms (as in
+ * happy eyeballs), so a healthy first entry isn't penalized by a burst of SYNs.
+ * Once the first endpoint answers, attempts that haven't started yet are
+ * skipped and those in flight get a short grace window before being
+ * cancelled, so a probe never waits out the full timeout when something fast
+ * is available.
+ *
+ * probe() blocks the calling thread on its own QEventLoop and can run on
+ * any thread. Never call it on the GUI thread.
+ */
+class EndpointProber {
+public:
+    struct Options {
+        int timeoutMs = 1500;  ///< hard cap for the whole probe
+        int staggerMs = 50;    ///< delay between consecutive attempt starts
+        int graceMs = 150;     ///< extra wait for slower endpoints after the first success
+        bool tls = false;      ///< also time the TLS handshake (no certificate verification)
+        QString tlsServerName; ///< SNI for the TLS handshake; defaults to the host
+    };
+
+    static std::vector<EndpointProbeResult> probe(const QStringList &addresses, const Options &options);
+    static std::vector<EndpointProbeResult> probe(const QStringList &addresses) { return probe(addresses, Options{}); }
+
+    /// Reachable endpoints by ascending RTT, then unreachable ones in their original order.
+    static QStringList rankedAddresses(const std::vector<EndpointProbeResult> &results);
+};
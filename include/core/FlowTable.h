@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QtGlobal>
+#include <cstddef>
+#include <vector>
+
+#include "ConnectionEventQueue.h"
+
+/// Per-domain traffic totals accumulated over a session.
+struct DomainTraffic {
+    quint32 domainId = 0;
+    FlowAction action = FlowAction::Unknown; ///< most recent decision for this domain
+    quint32 flows = 0;
+    quint64 upload = 0;
+    quint64 download = 0;
+    qint64 lastSeenMs = 0;
+
+    quint64 total() const { return upload + download; }
+};
+
+/// Joins connection_info records with tunnel_stats deltas by connection id
+/// and rolls them up per interned domain.
+///
+/// Connection ids live in a fixed-size open-addressing table (linear probing,
+/// bounded probe window). When the window around a key is full the stalest
+/// entry is overwritten, so memory stays constant no matter how many flows a
+/// long session opens; stats for an evicted or never-seen id are counted as
+/// unattributed. Single-threaded: fed from the GUI-side drain.
+class FlowTable {
+public:
+    explicit FlowTable(std::size_t flowCapacity = 16384);
+
+    void addConnection(const ConnectionEvent &ev);
+    void addStats(const FlowStatsEvent &ev);
+
+    /// All domains with at least one flow, sorted by total bytes, descending.
+    std::vector<DomainTraffic> domainsByTraffic() const;
+
+    quint64 unattributedBytes() const { return m_unattributed; }
+    /// Connection ids held in the table. The core never reports a flow
+    /// closing, so this counts every flow not yet evicted, not open ones.
+    std::size_t flowSlotsUsed() const { return m_liveFlows; }
+    std::size_t flowCapacity() const { return m_slots.size(); }
+
+    void clear();
+    /// Bumped by clear(): domain ids from an earlier generation may name other domains now.
+    quint64 generation() const { return m_generation; }
+
+private:
+    struct Slot {
+        quint64 key = 0; ///< connection id + 1; 0 marks an empty slot
+        quint32 domainId = 0;
+        quint32 stamp = 0; ///< insertion counter, for stalest-entry eviction
+    };
+
+    static constexpr std::size_t kMaxProbe = 16;
+
+    std::size_t slotIndex(quint64 key) const;
+    const Slot *find(quint64 key) const;
+
+    std::vector<Slot> m_slots;
+    std::size_t m_mask = 0;
+    std::size_t m_liveFlows = 0;
+    quint32 m_stamp = 0;
+    std::vector<DomainTraffic> m_domains; ///< indexed by interned domain id
+    quint64 m_unattributed = 0;
+    quint64 m_generation = 0;
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+#include "BoundedMpmcQueue.h"
+
+class QThread;
+class QThreadPool;
+
+/**
+ * Appends log chunks to a file from a dedicated thread.
+ *
+ * append() only moves the chunk into a lock-free ring, so logging costs the
+ * caller an enqueue instead of a write() and flush() per line. The writer
+ * drains the ring into one buffer and writes it in a single call once it
+ * reaches kBatchBytes or kFlushIntervalMs after the first unwritten chunk,
+ * whichever comes first.
+ *
+ * When the ring is full the producer wakes the writer and briefly yields
+ * (bounded back-pressure); if it is still full the chunk is dropped and
+ * counted, and the writer records how many chunks were lost in the file
+ * itself once it catches up.
+ *
+ * Rotation: when the file reaches Rotation::maxBytes, or its segment is
+ * older than Rotation::maxAgeSecs (start time kept in "<path>.start", so
+ * the age carries over restarts), it is renamed aside and a new one is
+ * started right away. A single background job per rotation then gzips the
+ * old segment into "<path>.1.gz", shifting older archives up and deleting
+ * the ones beyond Rotation::generations, so the writer never waits on
+ * compression and disk use stays bounded.
+ */
+class LogWriter {
+public:
+    static constexpr std::size_t kBatchBytes = 64 * 1024;
+    static constexpr int kFlushIntervalMs = 250;
+
+    struct Stats {
+        quint64 enqueued = 0;
+        quint64 dropped = 0;
+        quint64 bytesWritten = 0;
+        quint64 writes = 0; ///< write+flush batches issued
+        quint64 rotations = 0;
+    };
+
+    struct Rotation {
+        qint64 maxBytes = 10 * 1024 * 1024; ///< 0 = no size limit
+        int maxAgeSecs = 24 * 3600;          ///< 0 = no age limit
+        int generations = 5;                 ///< compressed archives kept; 0 = discard rotated segments
+    };
+
+    explicit LogWriter(std::size_t capacity = 8192);
+    ~LogWriter();
+
+    LogWriter(const LogWriter &) = delete;
+    LogWriter &operator=(const LogWriter &) = delete;
+
+    /// Target file; an empty path closes the file and discards further chunks.
+    /// Applied by the writer thread: chunks still queued may land in the old file.
+    void setPath(const QString &path);
+
+    /// Thread-safe. Returns false if the chunk was dropped.
+    bool append(QByteArray chunk);
+
+    /// Blocks until everything queued before the call is on disk.
+    void flush();
+
+    void setRotation(const Rotation &rotation);
+
+    Stats stats() const;
+
+    /// "<path>.<n>.gz"; generation 1 is the most recent archive, 0 one still being written.
+    static QString archivePath(const QString &path, int generation);
+    /// Bytes on disk for the log at `path`: the live file, its archives and
+    /// any segment still waiting to be compressed.
+    static qint64 footprint(const QString &path);
+
+private:
+    void run();
+    void wake();
+    static void compressSegment(const QString &path, const QString &segment, int generations);
+
+    BoundedMpmcQueue<QByteArray> m_ring;
+    std::atomic<quint64> m_enqueued{0};
+    std::atomic<quint64> m_dropped{0};
+    std::atomic<quint64> m_bytesWritten{0};
+    std::atomic<quint64> m_writes{0};
+    std::atomic<quint64> m_rotations{0};
+    QThreadPool *m_compressor = nullptr; // one thread: rotations are compressed in order
+
+    mutable std::mutex m_mutex; // guards everything below
+    std::condition_variable m_wake;
+    std::condition_variable m_flushed;
+    QString m_path;
+    bool m_pathChanged = false;
+    bool m_wakePending = false;
+    Rotation m_rotation;
+    quint64 m_flushRequests = 0;
+    quint64 m_flushesDone = 0;
+    bool m_stopping = false;
+    QThread *m_thread = nullptr;
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "RoutePrefix.h"
+
+/// Lossless aggregation: sorts, drops prefixes covered by another one and
+/// merges sibling pairs into their parent until no more merges apply. The
+/// result covers exactly the same addresses with the fewest prefixes.
+void aggregateRoutes(std::vector<Ipv4Route> &routes);
+void aggregateRoutes(std::vector<Ipv6Route> &routes);
+
+/// Lossy aggregation under a route budget: finds the longest prefix length L
+/// such that truncating every longer prefix to /L and aggregating leaves at
+/// most `maxRoutes` entries. Covers a superset of the input. No-op if the
+/// list already fits or `maxRoutes` is 0.
+void limitRoutes(std::vector<Ipv4Route> &routes, std::size_t maxRoutes);
+void limitRoutes(std::vector<Ipv6Route> &routes, std::size_t maxRoutes);
+
+/// Shares one budget between both families. IPv6 is kept exact while IPv4
+/// can absorb the loss, since routing lists are overwhelmingly IPv4.
+void limitRoutes(std::vector<Ipv4Route> &v4, std::vector<Ipv6Route> &v6, std::size_t maxRoutes);
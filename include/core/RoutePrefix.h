@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QtGlobal>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+/// Fixed-size IPv4 prefix. Address is in host byte order with host bits
+/// cleared, so plain integer comparison gives CIDR order.
+struct Ipv4Route {
+    quint32 addr = 0;
+    quint8 len = 0;
+    quint8 reserved[3] = {};
+
+    bool operator==(const Ipv4Route &o) const { return addr == o.addr && len == o.len; }
+    bool operator<(const Ipv4Route &o) const { return addr != o.addr ? addr < o.addr : len < o.len; }
+};
+
+/// Fixed-size IPv6 prefix. Address bytes are in network order with host
+/// bits cleared, so memcmp gives CIDR order.
+struct Ipv6Route {
+    quint8 addr[16] = {};
+    quint8 len = 0;
+    quint8 reserved[3] = {};
+
+    bool operator==(const Ipv6Route &o) const { return len == o.len && std::memcmp(addr, o.addr, 16) == 0; }
+    bool operator<(const Ipv6Route &o) const {
+        const int c = std::memcmp(addr, o.addr, 16);
+        return c != 0 ? c < 0 : len < o.len;
+    }
+};
+
+static_assert(sizeof(Ipv4Route) == 8, "Ipv4Route is part of the routing cache file format");
+static_assert(sizeof(Ipv6Route) == 20, "Ipv6Route is part of the routing cache file format");
+
+/// Parses "a.b.c.d" or "a.b.c.d/len". Host bits are masked off.
+bool parseIpv4Route(std::string_view text, Ipv4Route &out);
+/// Parses an IPv6 address with optional "/len". Host bits are masked off.
+bool parseIpv6Route(std::string_view text, Ipv6Route &out);
+
+std::string formatIpv4Route(const Ipv4Route &route);
+std::string formatIpv6Route(const Ipv6Route &route);
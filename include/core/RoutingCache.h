@@ -0,0 +1,83 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QtGlobal>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "RoutePrefix.h"
+
+/// Compiled form of a routing list text file.
+///
+/// The text list is parsed once into sorted arrays of fixed-size IPv4/IPv6
+/// prefixes, aggregated losslessly (see RouteAggregator.h) and written next
+/// to it with a small header (format version, size and mtime of the source it
+/// was built from, entry counts and an FNV-1a checksum of the payload). Later connects memory-map that file
+/// instead of re-reading the text, and only re-parse when the source changes.
+/// A list limited to a route budget (lossy, see limitRoutes()) gets its own
+/// compiled file, so the supernetting is also done once per list revision;
+/// writing it removes the files left by other budgets.
+class RoutingCache {
+public:
+    struct CompileStats {
+        std::size_t lines = 0;    ///< non-empty, non-comment lines seen
+        std::size_t rejected = 0; ///< lines that were not a valid prefix
+        std::size_t v4 = 0;       ///< unique IPv4 prefixes parsed
+        std::size_t v6 = 0;       ///< unique IPv6 prefixes parsed
+        std::size_t v4Aggregated = 0; ///< IPv4 prefixes written after aggregation
+        std::size_t v6Aggregated = 0; ///< IPv6 prefixes written after aggregation
+        std::size_t limited = 0;      ///< prefixes written under the route budget, 0 if it was not exceeded
+    };
+
+    RoutingCache() = default;
+    RoutingCache(const RoutingCache &) = delete;
+    RoutingCache &operator=(const RoutingCache &) = delete;
+    ~RoutingCache();
+
+    /// Compiled cache location for a given text list and route budget (0 = exact list).
+    static QString compiledPathFor(const QString &sourcePath, std::size_t maxRoutes = 0) {
+        return maxRoutes == 0 ? sourcePath + ".bin" : QString("%1.max%2.bin").arg(sourcePath).arg(maxRoutes);
+    }
+
+    /// Parses `sourcePath` and atomically replaces `cachePath` with the result,
+    /// widened to at most `maxRoutes` prefixes if that is non-zero. A limited
+    /// cache at compiledPathFor() replaces the list's caches for other budgets.
+    static bool compile(const QString &sourcePath, const QString &cachePath, CompileStats *stats = nullptr,
+                        QString *error = nullptr, std::size_t maxRoutes = 0);
+
+    /// Parses a routing list: one prefix per line, '#' comments, blank lines ignored.
+    static void parseList(const char *data, std::size_t size, std::vector<Ipv4Route> &v4,
+                          std::vector<Ipv6Route> &v6, CompileStats *stats = nullptr);
+
+    /// Maps a compiled cache. Fails if it is missing, corrupt, from another
+    /// format version, or was built from a different revision of `sourcePath`.
+    bool open(const QString &cachePath, const QString &sourcePath);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    QString errorString() const { return m_error; }
+
+    const Ipv4Route *v4() const { return m_v4; }
+    std::size_t v4Count() const { return m_v4Count; }
+    const Ipv6Route *v6() const { return m_v6; }
+    std::size_t v6Count() const { return m_v6Count; }
+    /// Unique prefixes in the source list before aggregation.
+    std::size_t inputPrefixCount() const { return m_inputPrefixes; }
+    /// Prefixes after lossless aggregation; more than v4Count() + v6Count() if the budget widened them.
+    std::size_t aggregatedPrefixCount() const { return m_aggregatedPrefixes; }
+
+    /// Formats every prefix as CIDR text, in the form the core expects.
+    void appendRoutes(std::vector<std::string> &out) const;
+
+private:
+    QFile m_file;
+    uchar *m_data = nullptr;
+    const Ipv4Route *m_v4 = nullptr;
+    const Ipv6Route *m_v6 = nullptr;
+    std::size_t m_v4Count = 0;
+    std::size_t m_v6Count = 0;
+    std::size_t m_inputPrefixes = 0;
+    std::size_t m_aggregatedPrefixes = 0;
+    QString m_error;
+};
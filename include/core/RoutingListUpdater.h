@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QSaveFile;
+
+/**
+ * Keeps the routing list cache fresh in the background.
+ *
+ * Refreshes on a schedule with a conditional GET (If-None-Match /
+ * If-Modified-Since; validators and the last check time live in a small
+ * "<cache>.meta" sidecar). The body is streamed into a QSaveFile, so the old
+ * list stays intact until the new one is complete and is then atomically
+ * renamed over it, and the compiled RoutingCache is rebuilt on a worker
+ * thread. Nothing here blocks the GUI thread.
+ *
+ * Usage:
+ *   auto *updater = new RoutingListUpdater(this);
+ *   updater->configure(url, cachePath, 24);
+ *   connect(updater, &RoutingListUpdater::finished, ...);
+ *   updater->start();
+ */
+class RoutingListUpdater : public QObject {
+    Q_OBJECT
+public:
+    explicit RoutingListUpdater(QObject *parent = nullptr);
+    ~RoutingListUpdater() override;
+
+    /**
+     * @param url            list source
+     * @param cachePath      text list location; the compiled cache lives next to it
+     * @param intervalHours  refresh period, 0 = only on demand
+     * @param maxRoutes      route budget to also build a limited cache for, 0 = none
+     */
+    void configure(const QString &url, const QString &cachePath, int intervalHours, int maxRoutes = 0);
+
+    /// Arms the schedule; refreshes right away if the cache is missing or older than the interval.
+    void start();
+    void stop();
+
+    /// Starts a refresh unless one is already running.
+    void refreshNow();
+
+    bool isRunning() const { return m_reply != nullptr; }
+
+signals:
+    /**
+     * Emitted when a refresh completes.
+     * @param ok       the cache is usable (fresh download or 304 Not Modified)
+     * @param changed  the list content was replaced
+     * @param message  human-readable summary for the log
+     */
+    void finished(bool ok, bool changed, const QString &message);
+
+private:
+    void onReadyRead();
+    void onFinished();
+    void loadValidators();
+    void saveValidators() const;
+    QString metaPath() const { return m_cachePath + ".meta"; }
+
+    QNetworkAccessManager *m_nam = nullptr;
+    QNetworkReply *m_reply = nullptr;
+    QSaveFile *m_out = nullptr;
+    QTimer m_timer;
+    QString m_url;
+    QString m_cachePath;
+    int m_intervalHours = 24;
+    int m_maxRoutes = 0;
+    QString m_etag;
+    QString m_lastModified;
+    QString m_validatorsUrl; ///< URL the stored validators belong to
+    QDateTime m_lastChecked; ///< last 200 or 304 from the server
+    qint64 m_bytesReceived = 0;
+    bool m_writeFailed = false;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/// Lock-free byte/packet counters bumped from the VPN core's callback threads.
+///
+/// Each writer thread is hashed onto its own cache-line-padded shard, so the
+/// hot path is a single relaxed fetch_add with no false sharing between core
+/// threads. The UI pulls a summed snapshot on its own timer instead of
+/// receiving one queued event per packet.
+class TrafficCounters {
+public:
+    struct Snapshot {
+        quint64 rxBytes = 0;
+        quint64 txBytes = 0;
+        quint64 rxPackets = 0;
+    };
+
+    TrafficCounters() = default;
+    TrafficCounters(const TrafficCounters &) = delete;
+    TrafficCounters &operator=(const TrafficCounters &) = delete;
+
+    void addRx(quint64 bytes, quint64 packets = 0) {
+        Shard &s = localShard();
+        s.rxBytes.fetch_add(bytes, std::memory_order_relaxed);
+        if (packets) {
+            s.rxPackets.fetch_add(packets, std::memory_order_relaxed);
+        }
+    }
+
+    void addTx(quint64 bytes) {
+        localShard().txBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    /// Sum of all shards. Shards are read independently, so a snapshot taken
+    /// while writers are active may be a few bytes behind — never ahead.
+    Snapshot snapshot() const;
+
+    /// Zero every shard. Concurrent increments may land on either side of the
+    /// reset; callers use this only at session boundaries.
+    void reset();
+
+private:
+    static constexpr std::size_t kShardCount = 16;
+    static constexpr std::size_t kCacheLine = 64;
+
+    struct alignas(kCacheLine) Shard {
+        std::atomic<quint64> rxBytes{0};
+        std::atomic<quint64> txBytes{0};
+        std::atomic<quint64> rxPackets{0};
+    };
+
+    Shard &localShard() { return m_shards[shardIndex()]; }
+    static std::size_t shardIndex();
+
+    std::array<Shard, kShardCount> m_shards;
+};
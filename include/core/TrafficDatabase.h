@@ -0,0 +1,121 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QtGlobal>
+#include <mutex>
+#include <vector>
+
+class QThreadPool;
+
+/**
+ * Per-profile traffic accounting persisted across sessions.
+ *
+ * Usage is kept as one fixed-width 32-byte record per profile per minute in
+ * an append-only file (traffic.db, next to configs.json): minute, profile
+ * id, rx/tx bytes, connected seconds and a checksum, little-endian. A year
+ * of continuous use is about 16 MB. Profiles are config file paths mapped to
+ * small ids in traffic_profiles.json.
+ *
+ * Records are appended in time order, so a sparse in-memory index (the
+ * minute of every kIndexStride-th record, rebuilt at startup by reading just
+ * those records) bisects a range query down to one block before scanning.
+ * A torn or corrupt tail left by a crash is truncated on open; a record
+ * whose checksum does not match is skipped.
+ *
+ * record() accumulates the current minute in memory; finished minutes are
+ * appended by a single background thread, so the GUI never waits on disk.
+ * Queries first wait for pending appends and include the open minute.
+ * record()/flush()/queries: GUI thread.
+ */
+class TrafficDatabase {
+public:
+    enum class Granularity { Minute, Day, Month };
+
+    static constexpr qint64 kIntervalMs = 60 * 1000;
+    static constexpr std::size_t kIndexStride = 256;
+
+    struct Record {
+        qint64 startMs = 0; ///< start of the minute, ms since epoch
+        quint32 profileId = 0;
+        quint64 rxBytes = 0;
+        quint64 txBytes = 0;
+        quint32 activeSecs = 0;
+    };
+
+    struct UsageRow {
+        qint64 periodStartMs = 0; ///< local midnight / first of the month for Day / Month
+        quint32 profileId = 0;
+        quint64 rxBytes = 0;
+        quint64 txBytes = 0;
+        quint64 activeSecs = 0;
+    };
+
+    struct Profile {
+        quint32 id = 0;
+        QString path; ///< config file
+        QString name() const;
+    };
+
+    explicit TrafficDatabase(QString dir = defaultDir());
+    ~TrafficDatabase(); // appends the open minute and waits for the writer
+
+    TrafficDatabase(const TrafficDatabase &) = delete;
+    TrafficDatabase &operator=(const TrafficDatabase &) = delete;
+
+    static QString defaultDir();
+
+    /// Adds `rxBytes`/`txBytes` transferred during the `spanMs` ending at
+    /// `nowMs` to the minute containing `nowMs` for the profile at `configPath`.
+    void record(const QString &configPath, qint64 nowMs, quint64 rxBytes, quint64 txBytes, qint64 spanMs);
+    /// Queues the open minute for writing, e.g. when a session ends.
+    void flush();
+    /// flush() and wait until every queued append is on disk, e.g. at quit.
+    void sync();
+
+    std::vector<Profile> profiles() const;
+    QString profileName(quint32 id) const;
+
+    /// Records overlapping [fromMs, toMs), oldest first; profileId 0 = all profiles.
+    std::vector<Record> records(qint64 fromMs, qint64 toMs, quint32 profileId = 0) const;
+    /// Records rolled up per local day or month and profile, oldest first.
+    std::vector<UsageRow> usage(Granularity granularity, qint64 fromMs, qint64 toMs, quint32 profileId = 0) const;
+    /// Writes usage() as CSV: period,profile,rx_bytes,tx_bytes,connected_secs.
+    bool exportCsv(const QString &path, Granularity granularity, qint64 fromMs, qint64 toMs, quint32 profileId = 0,
+                   QString *errorText = nullptr) const;
+
+private:
+    struct IndexEntry {
+        quint32 minute = 0;
+        quint64 record = 0;
+    };
+
+    struct Pending {
+        bool valid = false;
+        quint32 minute = 0;
+        quint32 profileId = 0;
+        quint64 rxBytes = 0;
+        quint64 txBytes = 0;
+        qint64 activeMs = 0;
+    };
+
+    quint32 profileIdFor(const QString &configPath);
+    void loadProfiles();
+    void saveProfiles() const;
+    void open();
+    void append(const Pending &pending);
+
+    const QString m_dir;
+    const QString m_dataPath;
+    QThreadPool *m_writer = nullptr; // one thread: appends stay in order
+
+    // GUI thread only
+    QHash<QString, quint32> m_profileIds;
+    std::vector<Profile> m_profiles;
+    Pending m_pending;
+    quint32 m_lastQueuedMinute = 0;
+
+    mutable std::mutex m_mutex; // guards the index, shared with the writer
+    std::vector<IndexEntry> m_index;
+    quint64 m_recordCount = 0;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QtGlobal>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+/// Throughput history rolled up into 1 s, 1 min and 1 h buckets.
+///
+/// Samples (bytes over an arbitrary span, e.g. one stats tick) are spread
+/// evenly over the wall-clock seconds they cover. Every completed second is
+/// then folded into the open bucket of each tier, which tracks the byte sum,
+/// the busiest second and the 95th percentile of per-second rates. The
+/// percentile comes from a log-scale histogram (kBinsPerOctave bins per
+/// doubling, reported as the bin's upper edge and capped at the max), so an
+/// hour bucket never holds its 3600 raw values. Each tier is a fixed ring,
+/// so memory is constant: kCapacity buckets per tier, oldest dropped first.
+/// History outlives VPN sessions; buckets only exist for seconds that were
+/// sampled, so a disconnected period shows up as a gap. GUI thread only.
+class TrafficHistory {
+public:
+    enum Tier { Seconds, Minutes, Hours, TierCount };
+
+    struct Bucket {
+        qint64 startMs = 0; ///< wall clock, aligned to the tier's bucket size
+        quint64 rxBytes = 0;
+        quint64 txBytes = 0;
+        quint64 rxMax = 0; ///< busiest second, bytes/s
+        quint64 txMax = 0;
+        quint64 rxP95 = 0; ///< 95th percentile of per-second rates, bytes/s
+        quint64 txP95 = 0;
+    };
+
+    static constexpr std::array<qint64, TierCount> kBucketMs = {1000, 60 * 1000, 3600 * 1000};
+    static constexpr std::array<std::size_t, TierCount> kCapacity = {600, 1440, 720}; // 10 min, 24 h, 30 days
+
+    TrafficHistory();
+
+    /// Bytes transferred during the `spanMs` ending at `endMs` (ms since epoch).
+    void addSample(qint64 endMs, quint64 rxBytes, quint64 txBytes, qint64 spanMs);
+
+    /// Closed buckets of a tier, oldest first. The bucket still filling is
+    /// not included.
+    std::size_t size(Tier tier) const { return m_levels[tier].count; }
+    const Bucket &at(Tier tier, std::size_t i) const;
+    /// Closed bucket of `tier` starting at `startMs`, or nullptr.
+    const Bucket *find(Tier tier, qint64 startMs) const;
+
+    void clear();
+
+private:
+    static constexpr int kBinsPerOctave = 8;
+    static constexpr int kBins = 1 + 48 * kBinsPerOctave; ///< [0], then 1 B/s .. 2^48 B/s
+
+    struct Histogram {
+        std::array<quint32, kBins> counts{};
+        quint32 total = 0;
+        void add(quint64 value);
+        quint64 percentile(double q) const;
+    };
+
+    struct Level {
+        std::vector<Bucket> ring; ///< allocated once, kCapacity entries
+        std::size_t head = 0;
+        std::size_t count = 0;
+        Bucket open;
+        bool hasOpen = false;
+        Histogram rxRates;
+        Histogram txRates;
+    };
+
+    void addToSecond(qint64 secondStartMs, quint64 rxBytes, quint64 txBytes);
+    void foldSecond(qint64 startMs, quint64 rxBytes, quint64 txBytes);
+    void closeBucket(Level &level);
+
+    std::array<Level, TierCount> m_levels;
+    qint64 m_secondStart = -1; ///< second currently being filled by samples
+    quint64 m_secondRx = 0;
+    quint64 m_secondTx = 0;
+};
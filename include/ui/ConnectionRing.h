@@ -3,10 +3,16 @@
 #include <QWidget>
 #include <QTimer>
 #include <QElapsedTimer>
+#include <QPixmap>
 
 /// Custom widget drawing a large circular ring with status text in the centre.
 /// Inspired by modern VPN apps: orange ring when connected, gray when off,
 /// animated arc while connecting. Clicking the ring toggles VPN on/off.
+///
+/// The static parts, the ring with its glow and the text, are rendered into
+/// device-pixel-ratio-aware pixmaps that are rebuilt only on resize, a
+/// status / text / colour change or a palette, font or screen change. An
+/// animation frame is then two blits plus the rotating arc.
 class ConnectionRing : public QWidget {
     Q_OBJECT
 public:
@@ -22,6 +28,10 @@ public:
     void setTextColor(const QColor &color);
     void setSubTextColor(const QColor &color);
 
+    /// While paused the animation timer is stopped and state changes don't
+    /// schedule repaints; resuming restarts the animation and repaints once.
+    void setRenderingPaused(bool paused);
+
     QSize sizeHint() const override { return {260, 260}; }
     QSize minimumSizeHint() const override { return {180, 180}; }
 
@@ -31,8 +41,17 @@ signals:
 protected:
     void paintEvent(QPaintEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
 
 private:
+    bool animating() const { return m_status == Connecting || m_status == Reconnecting || m_status == Disconnecting; }
+    void requestUpdate();
+    void invalidateText();
+    QPixmap makeLayer() const;
+    void renderRingLayer();
+    void renderTextLayer();
+
     Status  m_status    = Disconnected;
     QString m_text;
     QString m_subText;
@@ -41,4 +60,9 @@ private:
     QTimer  m_animTimer;
     QElapsedTimer m_elapsed;
     qreal   m_animAngle = 0.0;
+    bool    m_paused = false;
+    QPixmap m_ringLayer;  ///< glow + solid ring; unused while animating
+    QPixmap m_textLayer;  ///< status text + sub text
+    bool    m_ringLayerDirty = true;
+    bool    m_textLayerDirty = true;
 };
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+/// "512 B", "1.5 KB", "12.3 MB", "1.25 GB": binary units, as shown in the
+/// traffic views and dialogs. Append "/s" for a rate.
+QString formatBytes(quint64 bytes);
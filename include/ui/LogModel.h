@@ -0,0 +1,107 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QHash>
+#include <QTimer>
+#include <QtGlobal>
+#include <vector>
+
+/// Severity of a log-panel line; matches ag::LogLevel ordering.
+enum class LogLineLevel : quint8 { Error, Warn, Info, Debug, Trace };
+
+/// Compact record for one log-panel line: 16 bytes, text stored once in a pool.
+struct LogLine {
+    qint64 timestampMs = 0; ///< wall clock, ms since epoch
+    quint32 textId = 0;
+    LogLineLevel level = LogLineLevel::Info;
+};
+
+/**
+ * Fixed-capacity ring of log lines. Line text is interned in a
+ * reference-counted pool, so repeated lines (reconnect loops, connection
+ * info) are stored once, and a line's text is freed when its last
+ * occurrence is evicted. Memory is bounded by both the line capacity and
+ * a budget for the pool, which counts each entry's allocation, pool slot
+ * and hash node along with its text; the oldest lines go first. Line
+ * storage grows on demand up to the capacity.
+ */
+class LogLineStore {
+public:
+    LogLineStore(std::size_t capacity, std::size_t maxPoolBytes);
+
+    /// Appends a line, evicting the oldest one if the ring is full; returns
+    /// the number evicted. Only line capacity is enforced here.
+    std::size_t push(qint64 timestampMs, LogLineLevel level, const QByteArray &text);
+    /// Oldest lines to drop before appending `lines` lines with `textBytes`
+    /// of text so both limits hold (approximate for the pool budget).
+    std::size_t evictionsFor(std::size_t lines, std::size_t textBytes) const;
+    void dropFront(std::size_t count);
+    void clear();
+
+    std::size_t size() const { return m_size; }
+    std::size_t capacity() const { return m_capacity; }
+    /// Oldest line is index 0.
+    const LogLine &at(std::size_t i) const { return m_lines[(m_head + i) % m_lines.size()]; }
+    const QByteArray &text(const LogLine &line) const { return m_pool[line.textId].text; }
+
+private:
+    struct PoolEntry {
+        QByteArray text;
+        quint32 refs = 0;
+    };
+
+    /// Pool budget charged for one entry: its text plus the fixed per-entry overhead.
+    static std::size_t pooledBytes(std::size_t textBytes);
+    quint32 intern(const QByteArray &text);
+    void release(quint32 id);
+    void popFront();
+
+    const std::size_t m_capacity;
+    std::vector<LogLine> m_lines; ///< grows up to m_capacity, then wraps
+    std::size_t m_head = 0;
+    std::size_t m_size = 0;
+    std::vector<PoolEntry> m_pool;
+    std::vector<quint32> m_freeIds;
+    QHash<QByteArray, quint32> m_ids;
+    std::size_t m_poolBytes = 0; ///< pooledBytes() of every entry
+    const std::size_t m_maxPoolBytes;
+};
+
+/**
+ * List model over a LogLineStore for the log panel. Appends are batched:
+ * lines are staged and published to views at most every kPublishIntervalMs
+ * as one row removal (evictions) plus one row insertion, so a burst of
+ * trace output costs a couple of model signals, and the view, with uniform
+ * row heights, only ever lays out the visible rows.
+ */
+class LogModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    static constexpr int kPublishIntervalMs = 100;
+
+    explicit LogModel(std::size_t capacity = 1000000, std::size_t maxPoolBytes = 64 * 1024 * 1024,
+                      QObject *parent = nullptr);
+
+    /// Appends one line per '\n'-separated segment of `chunk` (GUI thread).
+    void append(LogLineLevel level, const QByteArray &chunk);
+    void clear();
+    /// All retained lines, oldest first, '\n'-terminated.
+    QString toPlainText() const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    struct StagedLine {
+        qint64 timestampMs;
+        LogLineLevel level;
+        QByteArray text;
+    };
+
+    void publish();
+
+    LogLineStore m_store;
+    std::vector<StagedLine> m_staged;
+    QTimer m_publishTimer;
+};
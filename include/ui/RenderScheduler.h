@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+
+class QWidget;
+class QWindow;
+
+/// Tracks whether a top-level window can actually be seen: shown, not
+/// minimized and exposed. Platforms that report occlusion (macOS, most
+/// compositing window managers) unexpose a window that is fully covered,
+/// so that case is caught as well. Widgets that animate or repaint on a
+/// timer pause while the window is inactive and catch up in one frame
+/// when activeChanged(true) arrives.
+class RenderScheduler : public QObject {
+    Q_OBJECT
+public:
+    explicit RenderScheduler(QWidget *window);
+
+    bool isActive() const { return m_active; }
+
+signals:
+    void activeChanged(bool active);
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event) override;
+
+private:
+    void attachHandle();
+    void reevaluate();
+
+    QWidget *m_window;
+    QPointer<QWindow> m_handle;
+    bool m_active = false;
+};
@@ -11,8 +11,10 @@
 
 class QCheckBox;
 class QComboBox;
+class QLabel;
 class QLineEdit;
 class QListWidget;
+class QSpinBox;
 class QStackedWidget;
 class QListWidgetItem;
 
@@ -24,6 +26,9 @@ public:
     bool saveLogs() const;
     QString logLevel() const;
     QString logPath() const;
+    int logRotateMb() const;
+    int logRotateHours() const;
+    int logGenerations() const;
     QString themeMode() const;
     bool autoConnectOnStart() const;
     bool showLogsPanel() const;
@@ -33,10 +38,15 @@ public:
     bool notifyOnlyErrors() const;
     bool killswitchEnabled() const;
     bool strictCertificateCheck() const;
+    bool endpointProbeEnabled() const;
+    bool endpointProbeTls() const;
+    bool makeBeforeBreak() const;
     bool routingEnabled() const;
     QString routingMode() const;
     QString routingSourceUrl() const;
     QString routingCachePath() const;
+    int routingMaxRoutes() const;
+    int routingRefreshHours() const;
 
     // Custom DNS
     bool customDnsEnabled() const;
@@ -72,6 +82,7 @@ signals:
 
 private:
     void showPerAppRulesDialog(const QString &lang, const AppSettings &settings);
+    void updateLogFootprint();
     QCheckBox *m_saveLogsCheck = nullptr;
     QComboBox *m_logLevelCombo = nullptr;
     QCheckBox *m_showLogsPanelCheck = nullptr;
@@ -81,14 +92,23 @@ private:
     QCheckBox *m_notifyErrorsOnlyCheck = nullptr;
     QCheckBox *m_killswitchCheck = nullptr;
     QCheckBox *m_strictCertCheck = nullptr;
+    QCheckBox *m_endpointProbeCheck = nullptr;
+    QCheckBox *m_endpointProbeTlsCheck = nullptr;
+    QCheckBox *m_makeBeforeBreakCheck = nullptr;
     QComboBox *m_themeModeCombo = nullptr;
     QLineEdit *m_logPathEdit = nullptr;
+    QSpinBox *m_logRotateMbSpin = nullptr;
+    QSpinBox *m_logRotateHoursSpin = nullptr;
+    QSpinBox *m_logGenerationsSpin = nullptr;
+    QLabel *m_logFootprintLabel = nullptr;
     QCheckBox *m_autoConnectCheck = nullptr;
     QCheckBox *m_routingEnableCheck = nullptr;
     QRadioButton *m_routingTunnelRadio = nullptr;
     QRadioButton *m_routingBypassRadio = nullptr;
     QLineEdit *m_routingUrlEdit = nullptr;
     QLineEdit *m_routingCacheEdit = nullptr;
+    QSpinBox *m_routingMaxRoutesSpin = nullptr;
+    QSpinBox *m_routingRefreshSpin = nullptr;
 
     // Custom DNS
     QCheckBox *m_customDnsCheck = nullptr;
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QDialog>
+#include <QTimer>
+#include <vector>
+
+#include "FlowTable.h"
+
+class ConnectionEventQueue;
+class QLabel;
+class QTableView;
+
+/// Table model over a FlowTable snapshot. Rows are plain structs, so the
+/// view only formats what is visible. A refresh updates rows in place and
+/// re-sorts through a layout change, so selection and scroll position survive.
+class TopTalkersModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column { DomainCol, ActionCol, FlowsCol, DownloadCol, UploadCol, TotalCol, ColumnCount };
+
+    TopTalkersModel(const QString &lang, QObject *parent = nullptr);
+
+    /// `generation` is FlowTable::generation() of the snapshot; a new one replaces every row.
+    void setRows(std::vector<DomainTraffic> rows, const ConnectionEventQueue *names, quint64 generation);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+private:
+    void sortRows(); ///< emits a layout change if the order moved
+
+    std::vector<DomainTraffic> m_rows;
+    std::vector<QString> m_names; ///< resolved when a domain first appears, parallel to m_rows
+    quint64 m_generation = 0;
+    int m_sortColumn = TotalCol;
+    Qt::SortOrder m_sortOrder = Qt::DescendingOrder;
+    bool m_ru = false;
+};
+
+/// Non-modal "top talkers" window: per-domain tunnel usage for the current
+/// session, refreshed from the owner's FlowTable while visible.
+class TopTalkersDialog : public QDialog {
+    Q_OBJECT
+public:
+    TopTalkersDialog(const QString &lang, const FlowTable *table, const ConnectionEventQueue *names,
+                     QWidget *parent = nullptr);
+
+public slots:
+    void refresh();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    const FlowTable *m_table;
+    const ConnectionEventQueue *m_names;
+    TopTalkersModel *m_model = nullptr;
+    QTableView *m_view = nullptr;
+    QLabel *m_summary = nullptr;
+    QTimer m_refreshTimer;
+    bool m_ru = false;
+};
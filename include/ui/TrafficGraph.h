@@ -1,15 +1,42 @@
 #pragma once
 
+#include <QPixmap>
+#include <QPointF>
 #include <QWidget>
 #include <QTimer>
-#include <deque>
+#include <array>
+
+class TrafficHistory;
 
 /// Mini sparkline traffic graph — shows last N seconds of Rx/Tx throughput.
+///
+/// Samples live in fixed-size rings; the window peak is kept by a monotonic
+/// queue, so adding a sample is O(1) regardless of the window size. The
+/// polylines are cached in sample space (x = sample number, y = bytes) and
+/// only ever gain a point at the back and lose one at the front: scrolling
+/// and rescaling are a painter transform. The rendered graph is cached in a
+/// pixmap that is redrawn only when data, geometry or scale changed, so any
+/// other repaint is a blit.
+///
+/// Clicking (or the mouse wheel) zooms out from the live window to the
+/// 1 s / 1 min / 1 h tiers of a TrafficHistory; hovering a bucket there
+/// shows its total, p95 and peak rates.
 class TrafficGraph : public QWidget {
     Q_OBJECT
 public:
+    enum class View { Live, Seconds, Minutes, Hours };
+
     explicit TrafficGraph(QWidget *parent = nullptr);
 
+    /// Source for the zoomed-out views; not owned, must outlive the graph.
+    void setHistory(const TrafficHistory *history);
+    void setView(View view);
+    View view() const { return m_view; }
+
+    /// While paused samples are still recorded but no repaint is scheduled;
+    /// resuming repaints once if anything changed.
+    void setRenderingPaused(bool paused);
+
     /// Push new data point (bytes since last push).
     void addSample(quint64 rx, quint64 tx);
 
@@ -21,10 +48,46 @@ public:
 
 protected:
     void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    bool event(QEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
 
 private:
-    struct Sample { quint64 rx = 0; quint64 tx = 0; };
-    std::deque<Sample> m_samples;
     static constexpr int kMaxSamples = 80;
+
+    /// Sample-space polyline with room to slide: points are appended until
+    /// the storage is full, then the live window is moved back to the start
+    /// (amortised O(1) per sample). Two spare slots past the end close the
+    /// fill polygon without copying.
+    struct Polyline {
+        std::array<QPointF, 2 * kMaxSamples + 2> points;
+        int start = 0;
+        int count = 0;
+        void push(qreal x, qreal y);
+        const QPointF *data() const { return points.data() + start; }
+    };
+
+    struct Peak { quint64 seq = 0; quint64 value = 0; };
+
+    void renderCache();
+    void renderHistory(QPainter &p);
+    /// Left edge of the zoomed-out view (start of its oldest bucket slot), or -1 if empty.
+    qint64 historyWindowStart() const;
+
+    Polyline m_rxLine;
+    Polyline m_txLine;
+    std::array<Peak, kMaxSamples> m_peaks; ///< ring; values strictly decreasing front to back
+    int m_peakHead = 0;
+    int m_peakCount = 0;
+    quint64 m_seq = 0; ///< samples pushed since reset
     quint64 m_peakValue = 1;
+
+    const TrafficHistory *m_history = nullptr;
+    View m_view = View::Live;
+    qint64 m_historyStamp = -1; ///< window start when last rendered; changes when a bucket closes
+
+    QPixmap m_cache;
+    bool m_cacheDirty = true;
+    bool m_paused = false;
 };
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QDialog>
+#include <vector>
+
+#include "TrafficDatabase.h"
+
+class QComboBox;
+class QLabel;
+class QTableView;
+
+/// Table model over TrafficDatabase::usage() rows, newest period first.
+class UsageModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column { PeriodCol, ProfileCol, DownloadCol, UploadCol, TotalCol, ConnectedCol, ColumnCount };
+
+    UsageModel(const QString &lang, QObject *parent = nullptr);
+
+    void setRows(std::vector<TrafficDatabase::UsageRow> rows, std::vector<QString> profileNames,
+                 TrafficDatabase::Granularity granularity);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    std::vector<TrafficDatabase::UsageRow> m_rows;
+    std::vector<QString> m_profileNames; ///< parallel to m_rows
+    TrafficDatabase::Granularity m_granularity = TrafficDatabase::Granularity::Day;
+    bool m_ru = false;
+};
+
+/// Non-modal "traffic usage" window: daily or monthly totals per VPN
+/// profile from the persistent traffic database, with CSV export. Queries
+/// run on the GUI thread, so the default range is bounded; "All time" reads
+/// the whole file.
+class UsageDialog : public QDialog {
+    Q_OBJECT
+public:
+    UsageDialog(const QString &lang, const TrafficDatabase *db, QWidget *parent = nullptr);
+
+public slots:
+    void refresh();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    enum Range { Last90Days, Last24Months, AllTime };
+
+    void exportCsv();
+    TrafficDatabase::Granularity granularity() const;
+    quint32 profileId() const;
+    qint64 rangeStartMs() const; ///< local midnight / first of the month the range starts at; 0 = all time
+
+    const TrafficDatabase *m_db;
+    UsageModel *m_model = nullptr;
+    QTableView *m_view = nullptr;
+    QComboBox *m_profileCombo = nullptr;
+    QComboBox *m_granularityCombo = nullptr;
+    QComboBox *m_rangeCombo = nullptr;
+    QLabel *m_summary = nullptr;
+    bool m_ru = false;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * Tracks the process's open file descriptors for the fd watchdog.
+ *
+ * sample() is cheap enough for a periodic timer even with a raised
+ * RLIMIT_NOFILE: on Linux the count comes from stat() on /proc/self/fd
+ * (procfs reports the number of open fds as its size since 6.2), on macOS
+ * from a single proc_pidinfo() call. Only older kernels fall back to
+ * walking the directory. Each sample feeds an EWMA of the growth rate, from
+ * which the time until the limit is reached is extrapolated.
+ *
+ * classify() is the expensive part: it walks /proc/self/fd, reads each link
+ * and, for sockets, looks the inode up in /proc/self/net so leaks can be
+ * pinned on TCP, UDP or unix sockets, pipes, eventfds and so on. It is meant
+ * to run only when sample() says the count is growing or already high.
+ */
+class FdMonitor {
+public:
+    struct Sample {
+        int open = -1;  ///< -1 when the platform can't count fds (Windows)
+        int limit = -1;
+        double growthPerMin = 0;       ///< EWMA of fds opened per minute, may be negative
+        double secsToExhaustion = -1;  ///< -1 when not growing
+        int growingSamples = 0;        ///< consecutive samples with a positive trend
+
+        double usage() const { return open >= 0 && limit > 0 ? static_cast<double>(open) / limit : 0; }
+    };
+
+    struct Breakdown {
+        int total = 0;
+        int tcp = 0;
+        int udp = 0;
+        int unixSockets = 0;
+        int otherSockets = 0;
+        int pipes = 0;
+        int eventfds = 0;
+        int epoll = 0;  ///< epoll / kqueue
+        int timerfds = 0;
+        int tun = 0;
+        int files = 0;
+        int other = 0;
+
+        bool isEmpty() const { return total == 0; }
+        /// "tcp 120, udp 3, pipe 4, ..." with zero counts omitted.
+        QString toString() const;
+    };
+
+    Sample sample();
+    Breakdown classify() const;
+    /// Clears the growth trend, e.g. after the core client was recreated.
+    void resetTrend();
+
+    static int openFdCount();
+    static int fdLimit();
+
+private:
+    qint64 m_lastSampleMs = 0;
+    int m_lastOpen = -1;
+    double m_growthPerMin = 0;
+    int m_growingSamples = 0;
+};
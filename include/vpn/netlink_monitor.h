@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+class QSocketNotifier;
+
+/**
+ * Watches rtnetlink (links, addresses, routes) for changes to the physical
+ * default route. Linux only; start() returns false elsewhere.
+ *
+ * Events are debounced: each one restarts a short quiet-period timer, capped
+ * so a constantly flapping link still gets re-evaluated every couple of
+ * seconds. After the quiet period the main routing table is checked for a
+ * default route (/0, up, not a reject route, not via a TUN/TAP device), so
+ * routes the tunnel installs never count as "the network is back".
+ */
+class NetlinkMonitor : public QObject {
+    Q_OBJECT
+public:
+    explicit NetlinkMonitor(QObject *parent = nullptr);
+    ~NetlinkMonitor() override;
+
+    bool start();
+    void stop();
+
+    bool isActive() const { return m_fd >= 0; }
+    bool defaultRouteAvailable() const { return m_available; }
+
+signals:
+    /**
+     * Emitted after debouncing when a default route appears or disappears,
+     * or moves to another interface/gateway (e.g. wifi roam).
+     */
+    void defaultRouteChanged(bool available);
+
+private:
+    void onReadable();
+    void evaluate();
+    static QString currentDefaultRoute();
+
+    int m_fd = -1;
+    QSocketNotifier *m_notifier = nullptr;
+    QTimer m_debounce;
+    QElapsedTimer m_firstPending; ///< first event of the burst being debounced
+    bool m_available = false;
+    QString m_route; ///< "iface gateway" of the default route last reported
+};
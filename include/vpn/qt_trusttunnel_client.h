@@ -1,9 +1,12 @@
 #pragma once
+#include <QElapsedTimer>
 #include <QObject>
 #include <QString>
+#include <QThreadPool>
 #include <QTimer>
-#include <QThread>
 #include <memory>
+#include <string>
+#include <vector>
 #include <functional>
 #include <optional>
 #include <chrono>
@@ -24,6 +27,17 @@ struct iovec {
 #include "vpn/trusttunnel/config.h"
 #include "vpn/vpn.h" // for ag::iovec on Windows
 
+#include <toml++/toml.h>
+
+#include "ConnectionEventQueue.h"
+#include "EndpointHealthStore.h"
+#include "TrafficCounters.h"
+#include "fd_monitor.h"
+#include "netlink_monitor.h"
+#include "reconnect_policy.h"
+#include "suspend_monitor.h"
+#include "vpn_command_executor.h"
+
 class QtTrustTunnelClient : public QObject {
     Q_OBJECT
 public:
@@ -38,16 +52,51 @@ public:
     };
     Q_ENUM(State)
 
+    /// Routing, DNS and bypass inputs layered on top of the config file.
+    struct RuleSet {
+        std::vector<std::string> includedRoutes;
+        std::vector<std::string> excludedRoutes;
+        std::vector<std::string> dnsServers;
+        std::vector<std::string> exclusions;
+    };
+
+    /// Entry-level difference between two RuleSets (order-insensitive).
+    struct RuleDelta {
+        size_t routesAdded = 0;
+        size_t routesRemoved = 0;
+        size_t exclusionsAdded = 0;
+        size_t exclusionsRemoved = 0;
+        bool dnsChanged = false;
+        bool sessionRebuilt = false; ///< running session had to be recreated to apply it
+
+        bool isEmpty() const {
+            return routesAdded == 0 && routesRemoved == 0 && exclusionsAdded == 0 && exclusionsRemoved == 0
+                    && !dnsChanged;
+        }
+    };
+
     explicit QtTrustTunnelClient(QObject *parent = nullptr);
     ~QtTrustTunnelClient();
 
     void setConfig(ag::TrustTunnelConfig config);
     bool loadConfigFromFile(const QString &path);
     void setAutoReconnectEnabled(bool enabled);
+    /// Probe all endpoint.addresses before each session and try the fastest first.
+    void setEndpointProbing(bool enabled, bool tls);
+    /// Planned reconnects (fd watchdog, core recovery) build the replacement config,
+    /// rank endpoints and complete a TLS handshake before the running session is torn down.
+    void setMakeBeforeBreak(bool enabled);
     void setReconnectBoundsMs(int initialDelayMs, int maxDelayMs);
+    /// Backoff strategy, retry cap and per-endpoint circuit breakers; see ReconnectPolicy.
+    void setReconnectPolicy(const ReconnectPolicy::Options &options);
 
     Q_INVOKABLE void connectVpn();
     Q_INVOKABLE void disconnectVpn();
+    /// Blocking final teardown for application exit: waits for the command
+    /// executor and disconnects the core on the calling thread, so system DNS
+    /// and routes are restored before the process goes away. No signals are
+    /// emitted afterwards. Idempotent; also run by the destructor.
+    void shutdown();
     Q_INVOKABLE bool isConnected() const;
     Q_INVOKABLE State state() const;
     void setLogLevel(const QString &level);
@@ -56,15 +105,31 @@ public:
     void setCustomDns(const std::vector<std::string> &dnsServers);
     void setExtraExclusions(const std::vector<std::string> &exclusions);
 
+    /// Applies rules edited while a session may be running. The new set is
+    /// diffed against what the live session was built with: an unchanged set
+    /// is a no-op. The core only takes routes/exclusions/DNS at construction,
+    /// so a real change on a connected session is applied by recreating the
+    /// core client from the already-loaded config (no settings round-trip, no
+    /// disconnected state in between). When idle the rules are just stored.
+    RuleDelta applyRules(const RuleSet &rules);
+
+    /// Cumulative tunnel traffic since the last resetTrafficCounters().
+    /// Cheap enough to poll from a UI timer; safe to call from any thread.
+    TrafficCounters::Snapshot trafficSnapshot() const;
+    void resetTrafficCounters();
+
+    /// Per-flow connection_info records written by core threads. The GUI
+    /// drains it in batches; see ConnectionEventQueue.
+    ConnectionEventQueue &connectionEvents() { return m_connectionEvents; }
+
 signals:
     void stateChanged(QtTrustTunnelClient::State state);
     void vpnConnected();
     void vpnDisconnected();
     void vpnError(const QString &msg);
     void connectProgress(const QString &step);
-    void connectionInfo(const QString &msg);
-    void clientOutput(const QString &bytes); // bytes in chunk
-    void tunnelStats(quint64 upload, quint64 download); // per-connection delta bytes
+    /// The previous core client has been disconnected and destroyed off the GUI thread.
+    void teardownFinished();
 
 private slots:
     void doConnectAttemptInThread();
@@ -72,13 +137,19 @@ private slots:
 private:
     ag::VpnCallbacks makeCallbacks();
     void doConnectAttempt();
-    void scheduleReconnect(const QString &reason);
+    bool buildConfigFromFile(const QString &path, bool rankEndpoints);
+    void rankEndpointAddresses(toml::table &table);
+    void scheduleReconnect(const QString &reason, FailureKind kind);
+    void recordEndpointOutcome(const QString &reason, bool endpointFault);
+    void recordKeptSessionEnd(const QString &endpoint, const QString &reason);
+    void plannedReconnect(const QString &reason, bool oldSessionUsable);
+    bool prepareStandby();
     void setState(State s);
-    void handleCoreStateChanged(ag::VpnSessionState state);
+    void handleCoreStateChanged(ag::VpnSessionState state, int errorCode, const QString &errorText);
     void teardownClient();
+    void teardownClientAsync(std::function<void()> then);
+    static RuleDelta diffRules(const RuleSet &from, const RuleSet &to);
     void checkFdHealth();
-    static int countOpenFds();
-    static int getFdLimit();
 
     std::unique_ptr<ag::TrustTunnelClient> m_client;
     std::unique_ptr<ag::AutoNetworkMonitor> m_networkMonitor;
@@ -89,16 +160,44 @@ private:
     std::vector<std::string> m_customDns;
     std::vector<std::string> m_extraExclusions;
     std::string m_originalExclusions; // exclusions from config file before our additions
+    std::vector<std::string> m_originalIncludedRoutes; // tun routes from config file before our additions
+    std::vector<std::string> m_originalExcludedRoutes;
+    std::vector<std::string> m_originalDnsUpstreams;
+    RuleSet m_activeRules; // what the current core client was built with
     QTimer m_reconnectTimer;
     QTimer m_fdWatchdogTimer;
+    FdMonitor m_fdMonitor;
+    QThreadPool m_fdClassifier;       // one thread: classify() walks every fd, off the GUI thread
+    bool m_fdClassifyPending = false; // a breakdown is being taken; its result is still queued
+    QElapsedTimer m_fdClassifyClock;
     QTimer m_networkWaitTimer;   // fires if we stay in WaitingForNetwork too long
-    QThread m_connectThread;
+    QTimer m_routeBackTimer;     // default route is back; fires if the core still hasn't recovered
+    NetlinkMonitor m_netlinkMonitor;
+    SuspendMonitor m_suspendMonitor;
+    VpnCommandExecutor m_executor;    // connect attempts and teardowns, one at a time, off the GUI thread
+    bool m_teardownPending = false;   // a Teardown command is queued or running
+    bool m_shutDown = false;          // shutdown() has run
+    std::vector<std::function<void()>> m_afterTeardown; // run on the GUI thread once it finishes
     State m_state = State::Disconnected;
     bool m_autoReconnect = true;
+    bool m_probeEndpoints = true;
+    bool m_probeTls = false;
+    bool m_makeBeforeBreak = false;
+    bool m_standbyCheck = false;     // rankEndpointAddresses(): always probe, with a TLS handshake
+    bool m_standbyReachable = false; // some endpoint answered the standby probe
+    bool m_standbyReady = false;     // m_config holds a verified replacement; don't rebuild it
+    bool m_keepOldSession = false;   // the old session still works; keep it if the standby fails
+    QString m_keptSessionEndpoint;   // its endpoint and why it's being replaced, recorded only once it is
+    QString m_keptSessionReason;
     bool m_stopRequested = false;
     bool m_everConnected = false; // true after first successful connect in this session
-    int m_reconnectDelayMs = 1000;
-    int m_reconnectMaxMs = 30000;
+    ReconnectPolicy m_reconnectPolicy; // also read by rankEndpointAddresses() on the worker thread
     ag::LogLevel m_logLevel = ag::LOG_LEVEL_INFO;
     std::chrono::steady_clock::time_point m_lastConnectAttempt{};
+    EndpointHealthStore m_endpointHealth;
+    QString m_sessionEndpoint; // first entry of endpoint.addresses the current client was built with
+    bool m_attemptPending = false; // connect() issued, outcome not yet recorded
+    std::chrono::steady_clock::time_point m_sessionStart{}; // set while a session is up
+    TrafficCounters m_traffic; // bumped directly from core callback threads
+    ConnectionEventQueue m_connectionEvents;
 };
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// What a failed attempt or dropped session most likely ran into.
+enum class FailureKind {
+    Auth,    ///< credentials rejected: retrying quickly won't help
+    Tls,     ///< handshake / certificate problem on the endpoint side
+    Timeout, ///< endpoint didn't answer in time
+    Network, ///< local connectivity (no route, interface down, resume from sleep)
+    Other,
+};
+
+const char *failureKindName(FailureKind kind);
+
+/**
+ * Decides whether and when to retry after a failure, and which endpoints
+ * are worth trying.
+ *
+ * Pure standard C++ (no Qt, no core) so the same code drives both the client
+ * and the reconnect simulator. Thread-safe.
+ *
+ * Delay: either the classic exponential backoff with ±20% jitter, or
+ * "decorrelated jitter" (next = random(base, prev * 3), capped), which
+ * spreads a fleet's retries better after a shared outage. Network failures
+ * retry at the base delay without escalating, since they're local and the
+ * network monitors trigger a reconnect as soon as connectivity returns.
+ *
+ * Circuit breakers: each endpoint is Closed until it fails
+ * `breakerThreshold` times in a row (auth failures trip it at once), then
+ * Open for a cool-down that doubles on every re-trip, then HalfOpen, which
+ * lets a single trial through: success closes it, failure re-opens it.
+ * Network failures never count against an endpoint. This is the only place
+ * endpoints are parked; EndpointHealthStore just scores them.
+ */
+class ReconnectPolicy {
+public:
+    enum class Jitter {
+        Proportional, ///< exponential backoff, ±20% jitter (previous behaviour)
+        Decorrelated,
+    };
+
+    enum class BreakerState { Closed, Open, HalfOpen };
+
+    struct Options {
+        Jitter jitter = Jitter::Proportional;
+        int baseDelayMs = 1000;
+        int maxDelayMs = 30000;
+        int maxRetries = 0;              ///< consecutive failed attempts before giving up, 0 = never
+        int breakerThreshold = 3;
+        int breakerCooldownMs = 30000;
+        int breakerMaxCooldownMs = 10 * 60 * 1000;
+    };
+
+    struct Decision {
+        bool retry = true;
+        int delayMs = 0;
+    };
+
+    ReconnectPolicy();
+    ReconnectPolicy(const Options &options, uint64_t seed);
+
+    void setOptions(const Options &options);
+    Options options() const;
+
+    /**
+     * Records a failed attempt (or a session that dropped) on `endpoint` and
+     * returns what to do next. `sinceAttemptMs` is the time since that
+     * attempt started; the proportional strategy escalates faster when it
+     * is short. When every known endpoint's breaker is open the delay is
+     * stretched to the earliest half-open time.
+     */
+    Decision onFailure(const std::string &endpoint, FailureKind kind, int64_t nowMs, int64_t sinceAttemptMs);
+
+    /// A session came up on `endpoint`: closes its breaker and resets backoff.
+    void onSuccess(const std::string &endpoint);
+
+    /// Forgets backoff state without touching breakers (e.g. after resume).
+    void resetBackoff();
+
+    BreakerState breakerState(const std::string &endpoint, int64_t nowMs) const;
+
+    /**
+     * Stable-sorts `endpoints` closed first, then half-open (due a trial),
+     * then open. The list is remembered as the candidate set, so a failure
+     * only waits for a breaker to half-open when no candidate is closed.
+     */
+    std::vector<std::string> order(const std::vector<std::string> &endpoints, int64_t nowMs);
+
+    int consecutiveFailures() const;
+
+private:
+    struct Breaker {
+        int consecutiveFailures = 0;
+        int trips = 0;
+        int64_t openUntilMs = 0; ///< 0 when closed
+    };
+
+    BreakerState stateLocked(const Breaker &b, int64_t nowMs) const;
+    int nextDelayLocked(FailureKind kind, int64_t sinceAttemptMs);
+
+    mutable std::mutex m_mutex;
+    Options m_options;
+    std::mt19937_64 m_rng;
+    int m_delayMs = 0; ///< last backoff delay, 0 = start from base
+    int m_failures = 0;
+    std::unordered_map<std::string, Breaker> m_breakers;
+    std::vector<std::string> m_candidates; ///< last list passed to order()
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QtGlobal>
+
+/**
+ * Detects system suspend/resume by comparing a clock that stops while the
+ * machine sleeps with one that keeps counting (CLOCK_MONOTONIC vs
+ * CLOCK_BOOTTIME on Linux, mach_absolute_time vs mach_continuous_time on
+ * macOS, QueryUnbiasedInterruptTime vs GetTickCount64 on Windows).
+ *
+ * A coarse poll is enough: the two clocks only diverge across a suspend, so
+ * a gap of more than a few seconds between them means the machine just woke
+ * up, regardless of how late the poll itself ran.
+ */
+class SuspendMonitor : public QObject {
+    Q_OBJECT
+public:
+    explicit SuspendMonitor(QObject *parent = nullptr);
+
+    void start();
+    void stop();
+
+signals:
+    /// Emitted on the first poll after a resume.
+    void resumed(qint64 sleptMs);
+
+private:
+    void poll();
+
+    QTimer m_timer;
+    qint64 m_lastAwakeMs = 0;   ///< clock that pauses during suspend
+    qint64 m_lastElapsedMs = 0; ///< clock that keeps running
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+class QThread;
+
+/**
+ * One long-lived worker thread that runs VPN session commands in order.
+ *
+ * Replaces restarting a QThread for every attempt: commands are queued and
+ * executed one at a time, so a teardown can never overlap a connect and no
+ * caller ever has to join the worker. Redundant commands are coalesced at
+ * post() time:
+ *  - a Connect while another Connect is still queued is dropped, since the
+ *    queued one reads the current config and rules when it runs (several
+ *    reconnects requested during a network flap become one attempt);
+ *  - a Teardown drops queued Connects (they would be torn down right away)
+ *    and is itself dropped if a Teardown is already queued.
+ *
+ * The thread is a QThread, so jobs may spin a local QEventLoop (endpoint
+ * probing does).
+ */
+class VpnCommandExecutor {
+public:
+    enum class Command {
+        Connect,  ///< build and start a session from the current settings (also applies rule changes)
+        Teardown, ///< disconnect and destroy the current session
+    };
+
+    VpnCommandExecutor();
+    ~VpnCommandExecutor();
+
+    /// @return false if the command was coalesced into one already queued.
+    bool post(Command command, std::function<void()> job);
+
+    /// A command is running or queued.
+    bool isBusy() const;
+    bool isWorkerThread() const;
+
+    /// Drops queued commands and waits for the running one to finish.
+    void shutdown();
+
+private:
+    struct Pending {
+        Command command;
+        std::function<void()> job;
+    };
+
+    void run();
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<Pending> m_queue;
+    bool m_running = false;
+    bool m_stopping = false;
+    QThread *m_thread = nullptr;
+};
@@ -21,6 +21,9 @@ AppSettings loadAppSettings() {
     out.save_logs = s.value("logs/save", true).toBool();
     out.log_level = s.value("logs/level", "info").toString();
     out.log_path = s.value("logs/path", defaultLogPath()).toString();
+    out.log_rotate_mb = s.value("logs/rotate_mb", 10).toInt();
+    out.log_rotate_hours = s.value("logs/rotate_hours", 24).toInt();
+    out.log_generations = s.value("logs/generations", 5).toInt();
     out.theme_mode = s.value("ui/theme_mode", "system").toString();
     out.language = s.value("ui/language", "en").toString();
     out.auto_connect_on_start = s.value("vpn/auto_connect_on_start", false).toBool();
@@ -31,12 +34,17 @@ AppSettings loadAppSettings() {
     out.notify_only_errors = s.value("ui/notify_only_errors", false).toBool();
     out.killswitch_enabled = s.value("vpn/killswitch_enabled", false).toBool();
     out.strict_certificate_check = s.value("vpn/strict_certificate_check", true).toBool();
+    out.endpoint_probe_enabled = s.value("vpn/endpoint_probe_enabled", true).toBool();
+    out.endpoint_probe_tls = s.value("vpn/endpoint_probe_tls", false).toBool();
+    out.make_before_break = s.value("vpn/make_before_break", false).toBool();
     out.first_run_checked = s.value("ui/first_run_checked", false).toBool();
     out.routing_enabled = s.value("routing/enabled", false).toBool();
     out.routing_mode = s.value("routing/mode", "tunnel_ru").toString();
     out.routing_cache_path = s.value("routing/cache_path", defaultRoutingCachePath()).toString();
     out.routing_source_url = s.value("routing/source_url",
             "https://antifilter.download/list/subnet.lst").toString();
+    out.routing_max_routes = s.value("routing/max_routes", 0).toInt();
+    out.routing_refresh_hours = s.value("routing/refresh_hours", 24).toInt();
     out.custom_dns_enabled = s.value("dns/custom_enabled", false).toBool();
     out.custom_dns_servers = s.value("dns/custom_servers", QStringList{"1.1.1.1", "8.8.8.8"}).toStringList();
     out.domain_bypass_enabled = s.value("bypass/enabled", false).toBool();
@@ -57,6 +65,9 @@ void saveAppSettings(const AppSettings &cfg) {
     s.setValue("logs/save", cfg.save_logs);
     s.setValue("logs/level", cfg.log_level);
     s.setValue("logs/path", cfg.log_path);
+    s.setValue("logs/rotate_mb", cfg.log_rotate_mb);
+    s.setValue("logs/rotate_hours", cfg.log_rotate_hours);
+    s.setValue("logs/generations", cfg.log_generations);
     s.setValue("ui/theme_mode", cfg.theme_mode);
     s.setValue("ui/language", cfg.language);
     s.setValue("vpn/auto_connect_on_start", cfg.auto_connect_on_start);
@@ -67,11 +78,16 @@ void saveAppSettings(const AppSettings &cfg) {
     s.setValue("ui/notify_only_errors", cfg.notify_only_errors);
     s.setValue("vpn/killswitch_enabled", cfg.killswitch_enabled);
     s.setValue("vpn/strict_certificate_check", cfg.strict_certificate_check);
+    s.setValue("vpn/endpoint_probe_enabled", cfg.endpoint_probe_enabled);
+    s.setValue("vpn/endpoint_probe_tls", cfg.endpoint_probe_tls);
+    s.setValue("vpn/make_before_break", cfg.make_before_break);
     s.setValue("ui/first_run_checked", cfg.first_run_checked);
     s.setValue("routing/enabled", cfg.routing_enabled);
     s.setValue("routing/mode", cfg.routing_mode);
     s.setValue("routing/cache_path", cfg.routing_cache_path);
     s.setValue("routing/source_url", cfg.routing_source_url);
+    s.setValue("routing/max_routes", cfg.routing_max_routes);
+    s.setValue("routing/refresh_hours", cfg.routing_refresh_hours);
     s.setValue("dns/custom_enabled", cfg.custom_dns_enabled);
     s.setValue("dns/custom_servers", cfg.custom_dns_servers);
     s.setValue("bypass/enabled", cfg.domain_bypass_enabled);
@@ -0,0 +1,93 @@
+#include "ConfigCache.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <mutex>
+
+#include "EndpointProber.h"
+
+struct ParsedConfigSlot {
+    qint64 mtimeMs = 0;
+    qint64 size = -1;
+    quint64 lastUsed = 0;
+    std::shared_ptr<const ParsedConfig> config;
+};
+
+static constexpr int kMaxCachedConfigs = 16;
+
+static std::mutex g_cacheMutex;
+static QHash<QString, ParsedConfigSlot> g_cache;
+static quint64 g_useCounter = 0;
+
+static QString nodeString(const toml::node_view<const toml::node> &n) {
+    if (const std::optional<std::string_view> v = n.value<std::string_view>()) {
+        return QString::fromUtf8(v->data(), static_cast<int>(v->size()));
+    }
+    return {};
+}
+
+static std::shared_ptr<const ParsedConfig> parseConfig(const QString &canonicalPath) {
+    auto out = std::make_shared<ParsedConfig>();
+    toml::parse_result parsed = toml::parse_file(canonicalPath.toStdString());
+    if (!parsed) {
+        const std::string_view descr = parsed.error().description();
+        out->error = QString::fromUtf8(descr.data(), static_cast<int>(descr.size()));
+        return out;
+    }
+    auto table = std::make_shared<toml::table>(std::move(parsed.table()));
+    const toml::table &t = *table;
+    out->hostname = nodeString(t["endpoint"]["hostname"]);
+    out->protocol = nodeString(t["endpoint"]["upstream_protocol"]).toUpper();
+    QString host;
+    quint16 port = 0;
+    if (splitHostPort(nodeString(t["endpoint"]["addresses"][0]), &host, &port)) {
+        out->port = QString::number(port);
+    }
+    out->table = std::move(table);
+    return out;
+}
+
+std::shared_ptr<const ParsedConfig> parsedConfig(const QString &path) {
+    const QFileInfo fi(path);
+    const QString key = fi.canonicalFilePath();
+    if (key.isEmpty()) {
+        // Missing file: nothing to cache, report it the way a parse would.
+        auto out = std::make_shared<ParsedConfig>();
+        out->error = QStringLiteral("File could not be opened for reading");
+        return out;
+    }
+    const qint64 mtimeMs = fi.lastModified().toMSecsSinceEpoch();
+    const qint64 size = fi.size();
+
+    {
+        std::lock_guard lock(g_cacheMutex);
+        auto it = g_cache.find(key);
+        if (it != g_cache.end() && it->mtimeMs == mtimeMs && it->size == size) {
+            it->lastUsed = ++g_useCounter;
+            return it->config;
+        }
+    }
+
+    // Parse outside the lock; a concurrent miss on the same file just parses twice.
+    std::shared_ptr<const ParsedConfig> config = parseConfig(key);
+
+    std::lock_guard lock(g_cacheMutex);
+    if (!g_cache.contains(key) && g_cache.size() >= kMaxCachedConfigs) {
+        auto oldest = g_cache.begin();
+        for (auto it = g_cache.begin(); it != g_cache.end(); ++it) {
+            if (it->lastUsed < oldest->lastUsed) {
+                oldest = it;
+            }
+        }
+        g_cache.erase(oldest);
+    }
+    g_cache.insert(key, ParsedConfigSlot{mtimeMs, size, ++g_useCounter, config});
+    return config;
+}
+
+void invalidateParsedConfig(const QString &path) {
+    const QString key = QFileInfo(path).canonicalFilePath();
+    std::lock_guard lock(g_cacheMutex);
+    g_cache.remove(key);
+}
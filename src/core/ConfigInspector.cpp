@@ -2,54 +2,21 @@
 
 #include <QCoreApplication>
 #include <QDir>
-#include <QElapsedTimer>
 #include <QFile>
 #include <QStringList>
-#include <QTcpSocket>
 
 #include <toml++/toml.h>
 
-static bool splitHostPort(QString s, QString *host, quint16 *port) {
-    s = s.trimmed();
-    if (s.startsWith("|")) {
-        s.remove(0, 1);
-    }
-    if (s.startsWith("[")) {
-        const int close = s.indexOf("]:");
-        if (close <= 0) {
-            return false;
-        }
-        *host = s.mid(1, close - 1);
-        bool ok = false;
-        const int p = s.mid(close + 2).toInt(&ok);
-        if (!ok || p <= 0 || p > 65535) {
-            return false;
-        }
-        *port = static_cast<quint16>(p);
-        return true;
-    }
-
-    const int colon = s.lastIndexOf(':');
-    if (colon <= 0 || colon == s.size() - 1) {
-        return false;
-    }
-    *host = s.left(colon);
-    bool ok = false;
-    const int p = s.mid(colon + 1).toInt(&ok);
-    if (!ok || p <= 0 || p > 65535) {
-        return false;
-    }
-    *port = static_cast<quint16>(p);
-    return true;
-}
+#include "ConfigCache.h"
+#include "EndpointProber.h"
 
 QString pingConfigFile(const QString &path) {
-    toml::parse_result parsed = toml::parse_file(path.toStdString());
-    if (!parsed) {
+    const std::shared_ptr<const ParsedConfig> parsed = parsedConfig(path);
+    if (!parsed->table) {
         return "Config parse error";
     }
 
-    const toml::table *endpoint = parsed["endpoint"].as_table();
+    const toml::table *endpoint = (*parsed->table)["endpoint"].as_table();
     if (!endpoint) {
         return "No [endpoint] section";
     }
@@ -58,41 +25,46 @@ QString pingConfigFile(const QString &path) {
         return "No endpoint.addresses";
     }
 
-    int attempts = 0;
+    QStringList addresses;
     for (const toml::node &n : *addrs) {
         std::optional<std::string_view> sv = n.value<std::string_view>();
-        if (!sv || sv->empty()) {
-            continue;
+        if (sv && !sv->empty()) {
+            addresses.push_back(QString::fromUtf8(sv->data(), static_cast<int>(sv->size())));
         }
-        QString host;
-        quint16 port = 0;
-        if (!splitHostPort(QString::fromUtf8(sv->data(), static_cast<int>(sv->size())), &host, &port)) {
+    }
+    if (addresses.isEmpty()) {
+        return "No valid host:port to ping";
+    }
+
+    // All addresses are probed concurrently, so the worst case is one
+    // timeout rather than one per endpoint.
+    EndpointProber::Options options;
+    options.timeoutMs = 1800;
+    options.staggerMs = 0;
+    options.graceMs = 1800;
+    const std::vector<EndpointProbeResult> results = EndpointProber::probe(addresses, options);
+    const EndpointProbeResult *best = nullptr;
+    int reachable = 0;
+    for (const EndpointProbeResult &r : results) {
+        if (!r.reachable) {
             continue;
         }
-
-        attempts++;
-        QTcpSocket sock;
-        QElapsedTimer t;
-        t.start();
-        sock.connectToHost(host, port);
-        if (sock.waitForConnected(1800)) {
-            sock.abort();
-            return QString("OK: %1:%2 in %3 ms").arg(host).arg(port).arg(t.elapsed());
+        ++reachable;
+        if (!best || r.rttMs < best->rttMs) {
+            best = &r;
         }
     }
-
-    if (attempts == 0) {
-        return "No valid host:port to ping";
+    if (!best) {
+        return "Fail: all endpoints timed out/unreachable";
     }
-    return "Fail: all endpoints timed out/unreachable";
+    return QString("OK: %1 in %2 ms (%3/%4 reachable)")
+            .arg(best->address.trimmed()).arg(best->rttMs).arg(reachable).arg(results.size());
 }
 
 QString buildConfigSummaryHtml(const QString &path) {
-    toml::parse_result parsed = toml::parse_file(path.toStdString());
-    if (!parsed) {
-        return QString("Failed to parse config: %1")
-                .arg(QString::fromUtf8(parsed.error().description().data(),
-                                       static_cast<int>(parsed.error().description().size())));
+    const std::shared_ptr<const ParsedConfig> parsed = parsedConfig(path);
+    if (!parsed->table) {
+        return QString("Failed to parse config: %1").arg(parsed->error);
     }
     auto getStr = [&](const toml::node_view<const toml::node> &n, const QString &def = "-") {
         if (auto v = n.value<std::string_view>()) return QString::fromUtf8(v->data(), static_cast<int>(v->size()));
@@ -113,7 +85,7 @@ QString buildConfigSummaryHtml(const QString &path) {
         }
         return out;
     };
-    const toml::table &t = parsed.table();
+    const toml::table &t = *parsed->table;
     QString endpointHost = getStr(t["endpoint"]["hostname"]);
     QString endpointUser = getStr(t["endpoint"]["username"]);
     QString endpointAddresses = getArrayStrings(t["endpoint"]["addresses"]).join("<br/>");
@@ -179,13 +151,12 @@ QString buildConfigSummaryHtml(const QString &path) {
 }
 
 QString buildConfigValidationHtml(const QString &path) {
-    toml::parse_result parsed = toml::parse_file(path.toStdString());
-    if (!parsed) {
+    const std::shared_ptr<const ParsedConfig> parsed = parsedConfig(path);
+    if (!parsed->table) {
         return QString("<h3>Validation</h3><p style='color:#c33'><b>Parse error:</b> %1</p>")
-                .arg(QString::fromUtf8(parsed.error().description().data(),
-                                       static_cast<int>(parsed.error().description().size())).toHtmlEscaped());
+                .arg(parsed->error.toHtmlEscaped());
     }
-    const toml::table &t = parsed.table();
+    const toml::table &t = *parsed->table;
     QStringList errors;
     QStringList warnings;
 
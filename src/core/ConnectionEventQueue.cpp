@@ -0,0 +1,115 @@
+#include "ConnectionEventQueue.h"
+
+#include <chrono>
+#include <mutex>
+
+QString flowActionName(FlowAction action) {
+    switch (action) {
+    case FlowAction::Bypass: return QStringLiteral("bypass");
+    case FlowAction::Tunnel: return QStringLiteral("tunnel");
+    case FlowAction::Reject: return QStringLiteral("reject");
+    default: return QStringLiteral("unknown");
+    }
+}
+
+ConnectionEventQueue::ConnectionEventQueue(std::size_t capacity, std::size_t maxDomains)
+    : m_ring(capacity)
+    , m_statsRing(capacity * 2)
+    , m_maxDomains(maxDomains) {
+    // Reserved ids: 0 = no domain, 1 = interner overflow.
+    m_domainNames.emplace_back("-");
+    m_domainNames.emplace_back("(other)");
+}
+
+quint32 ConnectionEventQueue::intern(const char *domain, quint16 &generation) {
+    if (!domain || !*domain) {
+        generation = m_generation.load(std::memory_order_relaxed);
+        return kNoDomainId;
+    }
+    const std::string_view key(domain);
+    {
+        // Fast path: a page load hits the same handful of domains repeatedly,
+        // so almost every call ends here under a shared lock.
+        std::shared_lock lock(m_domainsMutex);
+        generation = m_generation.load(std::memory_order_relaxed);
+        auto it = m_domainIds.find(key);
+        if (it != m_domainIds.end()) {
+            return it->second;
+        }
+    }
+    std::unique_lock lock(m_domainsMutex);
+    generation = m_generation.load(std::memory_order_relaxed);
+    auto it = m_domainIds.find(key);
+    if (it != m_domainIds.end()) {
+        return it->second;
+    }
+    if (m_domainNames.size() >= m_maxDomains) {
+        return kOverflowDomainId;
+    }
+    const auto id = static_cast<quint32>(m_domainNames.size());
+    m_domainNames.emplace_back(key);
+    m_domainIds.emplace(std::string(key), id);
+    return id;
+}
+
+bool ConnectionEventQueue::push(quint64 connectionId, FlowAction action, const char *domain) {
+    ConnectionEvent ev;
+    ev.connectionId = connectionId;
+    ev.timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    ev.domainId = intern(domain, ev.generation);
+    ev.action = action;
+    if (!m_ring.tryPush(ev)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool ConnectionEventQueue::pushStats(quint64 connectionId, quint64 upload, quint64 download) {
+    if (!m_statsRing.tryPush(FlowStatsEvent{connectionId, upload, download})) {
+        m_droppedStats.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+std::size_t ConnectionEventQueue::drain(std::vector<ConnectionEvent> &out, std::size_t max) {
+    const quint16 generation = m_generation.load(std::memory_order_relaxed); // only the GUI thread bumps it
+    std::size_t n = 0;
+    ConnectionEvent ev;
+    while (n < max && m_ring.tryPop(ev)) {
+        if (ev.generation != generation) {
+            continue; // a previous session's flow, its domain id no longer valid
+        }
+        out.push_back(ev);
+        ++n;
+    }
+    return n;
+}
+
+std::size_t ConnectionEventQueue::drainStats(std::vector<FlowStatsEvent> &out, std::size_t max) {
+    std::size_t n = 0;
+    FlowStatsEvent ev;
+    while (n < max && m_statsRing.tryPop(ev)) {
+        out.push_back(ev);
+        ++n;
+    }
+    return n;
+}
+
+void ConnectionEventQueue::resetDomains() {
+    std::unique_lock lock(m_domainsMutex);
+    m_generation.fetch_add(1, std::memory_order_relaxed);
+    m_domainIds.clear();
+    m_domainNames.resize(kOverflowDomainId + 1); // keep the reserved ids
+}
+
+QString ConnectionEventQueue::domainName(quint32 id) const {
+    std::shared_lock lock(m_domainsMutex);
+    if (id >= m_domainNames.size()) {
+        return QStringLiteral("-");
+    }
+    const std::string &name = m_domainNames[id];
+    return QString::fromUtf8(name.data(), static_cast<int>(name.size()));
+}
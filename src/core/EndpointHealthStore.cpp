@@ -0,0 +1,222 @@
+#include "EndpointHealthStore.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+
+#include "ConfigStore.h"
+
+static constexpr double kAlpha = 0.3;              // EWMA weight of the newest sample
+static constexpr qint64 kShortSessionSecs = 10;    // sessions shorter than this count as failures
+static constexpr int kMaxEntries = 256;
+
+static double ewma(double current, double sample) {
+    return current < 0 ? sample : current + kAlpha * (sample - current);
+}
+
+static qint64 nowMs() {
+    return QDateTime::currentMSecsSinceEpoch();
+}
+
+EndpointHealthStore::EndpointHealthStore(QString path)
+    : m_path(std::move(path)) {
+    load();
+}
+
+EndpointHealthStore::~EndpointHealthStore() {
+    flush();
+}
+
+QString EndpointHealthStore::defaultPath() {
+    return QFileInfo(storagePath()).absolutePath() + "/endpoint_health.json";
+}
+
+void EndpointHealthStore::recordProbe(const QString &address, bool reachable, qint64 rttMs) {
+    std::lock_guard lock(m_mutex);
+    Entry &e = m_entries[normalize(address)];
+    if (reachable) {
+        e.latencyMs = ewma(e.latencyMs, static_cast<double>(rttMs));
+    } else {
+        // A failed probe is weaker evidence than a failed session: nudge the
+        // rate but don't touch the consecutive-failure cool-down.
+        e.failureRate = ewma(e.failureRate, 0.5);
+    }
+    changedLocked(nowMs());
+}
+
+void EndpointHealthStore::recordConnected(const QString &address, qint64 connectMs) {
+    std::lock_guard lock(m_mutex);
+    Entry &e = m_entries[normalize(address)];
+    e.attempts++;
+    e.consecutiveFailures = 0;
+    e.failureRate = ewma(e.failureRate, 0.0);
+    e.connectMs = ewma(e.connectMs, static_cast<double>(connectMs));
+    e.lastSuccessMs = nowMs();
+    changedLocked(nowMs());
+}
+
+void EndpointHealthStore::failLocked(Entry &e, const QString &reason, qint64 now) {
+    e.failures++;
+    e.consecutiveFailures++;
+    e.failureRate = ewma(e.failureRate, 1.0);
+    e.lastFailureMs = now;
+    e.lastReason = reason;
+}
+
+void EndpointHealthStore::recordFailure(const QString &address, const QString &reason) {
+    std::lock_guard lock(m_mutex);
+    Entry &e = m_entries[normalize(address)];
+    e.attempts++;
+    failLocked(e, reason, nowMs());
+    changedLocked(nowMs());
+}
+
+void EndpointHealthStore::recordSessionEnd(const QString &address, qint64 lifetimeSecs, const QString &reason,
+                                           bool failure) {
+    std::lock_guard lock(m_mutex);
+    Entry &e = m_entries[normalize(address)];
+    e.sessionSecs = ewma(e.sessionSecs, static_cast<double>(lifetimeSecs));
+    e.lastReason = reason;
+    if (failure && lifetimeSecs < kShortSessionSecs) {
+        // Connected but dropped almost immediately: as bad as not connecting.
+        failLocked(e, reason, nowMs());
+    }
+    changedLocked(nowMs());
+}
+
+void EndpointHealthStore::changedLocked(qint64 now) {
+    m_dirty = true;
+    if (now - m_lastSaveMs >= kSaveIntervalMs) {
+        saveLocked(now);
+    }
+}
+
+void EndpointHealthStore::flush() {
+    std::lock_guard lock(m_mutex);
+    if (m_dirty) {
+        saveLocked(nowMs());
+    }
+}
+
+EndpointHealthStore::Entry EndpointHealthStore::entry(const QString &address) const {
+    std::lock_guard lock(m_mutex);
+    return m_entries.value(normalize(address));
+}
+
+double EndpointHealthStore::scoreLocked(const QString &address, qint64 probeRttMs) const {
+    const auto it = m_entries.constFind(normalize(address));
+    const Entry e = it != m_entries.constEnd() ? *it : Entry{};
+    double latency = probeRttMs >= 0 ? static_cast<double>(probeRttMs) : e.latencyMs;
+    if (latency < 0) {
+        latency = 500; // never measured: behind anything known to be healthy and fast
+    }
+    return latency * (1.0 + 3.0 * e.failureRate);
+}
+
+QStringList EndpointHealthStore::rank(const QStringList &addresses,
+                                      const std::vector<EndpointProbeResult> &probe) const {
+    struct Candidate {
+        QString address;
+        bool reachable = true;
+        double score = 0;
+    };
+    std::vector<Candidate> candidates;
+    candidates.reserve(static_cast<size_t>(addresses.size()));
+    {
+        std::lock_guard lock(m_mutex);
+        for (const QString &a : addresses) {
+            qint64 rtt = -1;
+            bool reachable = true;
+            for (const EndpointProbeResult &r : probe) {
+                if (r.address == a) {
+                    reachable = r.reachable;
+                    rtt = r.rttMs;
+                    break;
+                }
+            }
+            candidates.push_back({a, reachable, scoreLocked(a, rtt)});
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate &x, const Candidate &y) {
+        if (x.reachable != y.reachable) {
+            return x.reachable;
+        }
+        return x.score < y.score;
+    });
+    QStringList out;
+    for (const Candidate &c : candidates) {
+        out.push_back(c.address);
+    }
+    return out;
+}
+
+void EndpointHealthStore::load() {
+    QFile f(m_path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const QJsonObject root = QJsonDocument::fromJson(f.readAll()).object();
+    // Version 1 mixed connect times into latency_ms; that history is not comparable to probe RTT.
+    const bool mixedLatency = root.value("version").toInt() < 2;
+    const QJsonObject endpoints = root.value("endpoints").toObject();
+    for (auto it = endpoints.begin(); it != endpoints.end(); ++it) {
+        const QJsonObject o = it.value().toObject();
+        Entry e;
+        e.latencyMs = mixedLatency ? -1 : o.value("latency_ms").toDouble(-1);
+        e.connectMs = o.value("connect_ms").toDouble(-1);
+        e.failureRate = o.value("failure_rate").toDouble(0);
+        e.sessionSecs = o.value("session_secs").toDouble(-1);
+        e.attempts = static_cast<quint32>(o.value("attempts").toInteger());
+        e.failures = static_cast<quint32>(o.value("failures").toInteger());
+        e.consecutiveFailures = static_cast<quint32>(o.value("consecutive_failures").toInteger());
+        e.lastSuccessMs = o.value("last_success").toInteger();
+        e.lastFailureMs = o.value("last_failure").toInteger();
+        e.lastReason = o.value("last_reason").toString();
+        m_entries.insert(it.key(), e);
+    }
+}
+
+void EndpointHealthStore::saveLocked(qint64 now) {
+    m_dirty = false;
+    m_lastSaveMs = now;
+    // Only the most recently active endpoints are kept, so configs that were
+    // deleted long ago don't accumulate forever.
+    QList<QString> keys = m_entries.keys();
+    if (keys.size() > kMaxEntries) {
+        std::sort(keys.begin(), keys.end(), [this](const QString &a, const QString &b) {
+            const Entry &x = m_entries[a];
+            const Entry &y = m_entries[b];
+            return std::max(x.lastSuccessMs, x.lastFailureMs) > std::max(y.lastSuccessMs, y.lastFailureMs);
+        });
+        keys.resize(kMaxEntries);
+    }
+    QJsonObject endpoints;
+    for (const QString &key : keys) {
+        const Entry &e = m_entries[key];
+        QJsonObject o;
+        o.insert("latency_ms", std::round(e.latencyMs * 10) / 10);
+        o.insert("connect_ms", std::round(e.connectMs * 10) / 10);
+        o.insert("failure_rate", std::round(e.failureRate * 1000) / 1000);
+        o.insert("session_secs", std::round(e.sessionSecs));
+        o.insert("attempts", static_cast<qint64>(e.attempts));
+        o.insert("failures", static_cast<qint64>(e.failures));
+        o.insert("consecutive_failures", static_cast<qint64>(e.consecutiveFailures));
+        o.insert("last_success", e.lastSuccessMs);
+        o.insert("last_failure", e.lastFailureMs);
+        o.insert("last_reason", e.lastReason);
+        endpoints.insert(key, o);
+    }
+    QJsonObject root;
+    root.insert("version", 2);
+    root.insert("endpoints", endpoints);
+    QSaveFile f(m_path);
+    if (f.open(QIODevice::WriteOnly)) {
+        f.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+        f.commit();
+    }
+}
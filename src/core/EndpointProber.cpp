@@ -0,0 +1,178 @@
+#include "EndpointProber.h"
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTcpSocket>
+#include <QTimer>
+#include <algorithm>
+#include <memory>
+
+#if QT_CONFIG(ssl)
+#include <QSslConfiguration>
+#include <QSslSocket>
+#endif
+
+bool splitHostPort(QString s, QString *host, quint16 *port) {
+    s = s.trimmed();
+    if (s.startsWith("|")) {
+        s.remove(0, 1);
+    }
+    if (s.startsWith("[")) {
+        const int close = s.indexOf("]:");
+        if (close <= 0) {
+            return false;
+        }
+        *host = s.mid(1, close - 1);
+        bool ok = false;
+        const int p = s.mid(close + 2).toInt(&ok);
+        if (!ok || p <= 0 || p > 65535) {
+            return false;
+        }
+        *port = static_cast<quint16>(p);
+        return true;
+    }
+
+    const int colon = s.lastIndexOf(':');
+    if (colon <= 0 || colon == s.size() - 1) {
+        return false;
+    }
+    *host = s.left(colon);
+    bool ok = false;
+    const int p = s.mid(colon + 1).toInt(&ok);
+    if (!ok || p <= 0 || p > 65535) {
+        return false;
+    }
+    *port = static_cast<quint16>(p);
+    return true;
+}
+
+std::vector<EndpointProbeResult> EndpointProber::probe(const QStringList &addresses, const Options &options) {
+    std::vector<EndpointProbeResult> results(static_cast<size_t>(addresses.size()));
+    if (addresses.isEmpty()) {
+        return results;
+    }
+
+    QEventLoop loop;
+    QElapsedTimer clock;
+    clock.start();
+    std::vector<std::unique_ptr<QTcpSocket>> sockets(results.size());
+    std::vector<qint64> startedAt(results.size(), -1);
+    int pending = 0;
+    bool anySuccess = false;
+
+    QTimer deadline;
+    deadline.setSingleShot(true);
+    QObject::connect(&deadline, &QTimer::timeout, &loop, &QEventLoop::quit);
+    QTimer grace;
+    grace.setSingleShot(true);
+    QObject::connect(&grace, &QTimer::timeout, &loop, &QEventLoop::quit);
+
+    auto settle = [&](size_t i, bool ok, const QString &error) {
+        EndpointProbeResult &r = results[i];
+        if (r.reachable || !r.error.isEmpty()) {
+            return; // already settled
+        }
+        r.reachable = ok;
+        r.error = ok ? QString() : (error.isEmpty() ? QStringLiteral("failed") : error);
+        if (ok) {
+            r.rttMs = clock.elapsed() - startedAt[i];
+            if (!anySuccess) {
+                anySuccess = true;
+                grace.start(options.graceMs);
+            }
+        }
+        sockets[i]->abort();
+        if (--pending == 0) {
+            loop.quit();
+        }
+    };
+
+    for (int idx = 0; idx < addresses.size(); ++idx) {
+        const auto i = static_cast<size_t>(idx);
+        results[i].address = addresses[idx];
+        QString host;
+        quint16 port = 0;
+        if (!splitHostPort(addresses[idx], &host, &port)) {
+            results[i].error = QStringLiteral("invalid address");
+            continue;
+        }
+        ++pending;
+#if QT_CONFIG(ssl)
+        if (options.tls) {
+            auto *ssl = new QSslSocket();
+            QSslConfiguration conf = ssl->sslConfiguration();
+            // Only the handshake latency matters here; the core verifies the server itself.
+            conf.setPeerVerifyMode(QSslSocket::VerifyNone);
+            ssl->setSslConfiguration(conf);
+            QObject::connect(ssl, &QSslSocket::encrypted, &loop, [&settle, i]() { settle(i, true, {}); });
+            sockets[i].reset(ssl);
+        } else
+#endif
+        {
+            sockets[i] = std::make_unique<QTcpSocket>();
+            QObject::connect(sockets[i].get(), &QTcpSocket::connected, &loop, [&settle, i]() { settle(i, true, {}); });
+        }
+        QTcpSocket *sock = sockets[i].get();
+        QObject::connect(sock, &QAbstractSocket::errorOccurred, &loop,
+                [&settle, sock, i](QAbstractSocket::SocketError) { settle(i, false, sock->errorString()); });
+
+        const int delay = options.staggerMs * idx;
+        const QString sni = options.tlsServerName.isEmpty() ? host : options.tlsServerName;
+        auto start = [&, i, sock, host, port, sni]() {
+            if (anySuccess) {
+                // Something already answered; don't open new connections just to rank them.
+                settle(i, false, QStringLiteral("not attempted"));
+                return;
+            }
+            startedAt[i] = clock.elapsed();
+#if QT_CONFIG(ssl)
+            if (auto *ssl = qobject_cast<QSslSocket *>(sock)) {
+                ssl->connectToHostEncrypted(host, port, sni);
+                return;
+            }
+#endif
+            sock->connectToHost(host, port);
+        };
+        if (delay == 0) {
+            start();
+        } else {
+            QTimer::singleShot(delay, &loop, start);
+        }
+    }
+
+    if (pending > 0) {
+        deadline.start(options.timeoutMs);
+        loop.exec();
+    }
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        EndpointProbeResult &r = results[i];
+        if (!r.reachable && r.error.isEmpty()) {
+            r.error = startedAt[i] < 0 ? QStringLiteral("not attempted") : QStringLiteral("timed out");
+        }
+        if (sockets[i]) {
+            sockets[i]->disconnect();
+            sockets[i]->abort();
+        }
+    }
+    return results;
+}
+
+QStringList EndpointProber::rankedAddresses(const std::vector<EndpointProbeResult> &results) {
+    std::vector<const EndpointProbeResult *> order;
+    order.reserve(results.size());
+    for (const EndpointProbeResult &r : results) {
+        order.push_back(&r);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const EndpointProbeResult *a, const EndpointProbeResult *b) {
+        if (a->reachable != b->reachable) {
+            return a->reachable;
+        }
+        return a->reachable && a->rttMs < b->rttMs;
+    });
+    QStringList out;
+    for (const EndpointProbeResult *r : order) {
+        out.push_back(r->address);
+    }
+    return out;
+}
@@ -0,0 +1,105 @@
+#include "FlowTable.h"
+
+#include <algorithm>
+
+FlowTable::FlowTable(std::size_t flowCapacity) {
+    std::size_t cap = 64;
+    while (cap < flowCapacity) {
+        cap <<= 1;
+    }
+    m_slots.resize(cap);
+    m_mask = cap - 1;
+}
+
+std::size_t FlowTable::slotIndex(quint64 key) const {
+    // splitmix64 finalizer: core connection ids are sequential, spread them out.
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return static_cast<std::size_t>(key) & m_mask;
+}
+
+const FlowTable::Slot *FlowTable::find(quint64 key) const {
+    std::size_t idx = slotIndex(key);
+    for (std::size_t i = 0; i < kMaxProbe; ++i, idx = (idx + 1) & m_mask) {
+        const Slot &slot = m_slots[idx];
+        if (slot.key == key) {
+            return &slot;
+        }
+        if (slot.key == 0) {
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+void FlowTable::addConnection(const ConnectionEvent &ev) {
+    const quint64 key = ev.connectionId + 1;
+    std::size_t idx = slotIndex(key);
+    Slot *target = nullptr;
+    Slot *stalest = nullptr;
+    for (std::size_t i = 0; i < kMaxProbe; ++i, idx = (idx + 1) & m_mask) {
+        Slot &slot = m_slots[idx];
+        if (slot.key == key || slot.key == 0) {
+            target = &slot;
+            break;
+        }
+        // Unsigned difference keeps the comparison correct across stamp wrap-around.
+        if (!stalest || (m_stamp - slot.stamp) > (m_stamp - stalest->stamp)) {
+            stalest = &slot;
+        }
+    }
+    if (!target) {
+        target = stalest; // window full: recycle the oldest flow, size stays bounded
+    } else if (target->key == 0) {
+        ++m_liveFlows;
+    }
+    target->key = key;
+    target->domainId = ev.domainId;
+    target->stamp = ++m_stamp;
+
+    if (ev.domainId >= m_domains.size()) {
+        m_domains.resize(ev.domainId + 1);
+    }
+    DomainTraffic &d = m_domains[ev.domainId];
+    d.domainId = ev.domainId;
+    d.action = ev.action;
+    d.flows++;
+    d.lastSeenMs = ev.timestampMs;
+}
+
+void FlowTable::addStats(const FlowStatsEvent &ev) {
+    const Slot *slot = find(ev.connectionId + 1);
+    if (!slot || slot->domainId >= m_domains.size()) {
+        m_unattributed += ev.upload + ev.download;
+        return;
+    }
+    DomainTraffic &d = m_domains[slot->domainId];
+    d.upload += ev.upload;
+    d.download += ev.download;
+}
+
+std::vector<DomainTraffic> FlowTable::domainsByTraffic() const {
+    std::vector<DomainTraffic> out;
+    out.reserve(m_domains.size());
+    for (const DomainTraffic &d : m_domains) {
+        if (d.flows > 0) {
+            out.push_back(d);
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const DomainTraffic &a, const DomainTraffic &b) {
+        return a.total() > b.total();
+    });
+    return out;
+}
+
+void FlowTable::clear() {
+    std::fill(m_slots.begin(), m_slots.end(), Slot{});
+    m_liveFlows = 0;
+    m_stamp = 0;
+    m_domains.clear();
+    m_unattributed = 0;
+    ++m_generation;
+}
@@ -0,0 +1,403 @@
+#include "LogWriter.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
+#include <QThreadPool>
+#include <array>
+#include <chrono>
+#include <thread>
+
+static constexpr int kPushRetries = 8; // yields before a chunk is dropped
+static constexpr qint64 kGzipMemberBytes = 4 * 1024 * 1024; // segment input per gzip member
+static const QString kSegmentInfix = QStringLiteral(".rotating.");
+
+static quint32 crc32(const QByteArray &data) {
+    static const std::array<quint32, 256> table = []() {
+        std::array<quint32, 256> t{};
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    quint32 crc = 0xFFFFFFFFu;
+    for (const char ch : data) {
+        crc = table[(crc ^ static_cast<quint8>(ch)) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static void appendLe32(QByteArray &out, quint32 v) {
+    for (int i = 0; i < 4; ++i) {
+        out.append(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+}
+
+/// gzip member around qCompress() output, so archives open with zcat/less.
+/// qCompress() yields a 4-byte length followed by a zlib stream: a 2-byte
+/// header, the raw deflate data and a 4-byte Adler-32 trailer. gzip wants
+/// the same deflate data with its own header and a CRC-32 + size trailer.
+static QByteArray gzipCompress(const QByteArray &raw) {
+    const QByteArray z = qCompress(raw, 6);
+    if (z.size() < 4 + 2 + 4) {
+        return {};
+    }
+    static const char header[10] = {0x1f, static_cast<char>(0x8b), 8, 0, 0, 0, 0, 0, 0, static_cast<char>(0xff)};
+    QByteArray out;
+    out.reserve(z.size() + 12);
+    out.append(header, sizeof(header));
+    out.append(z.constData() + 6, z.size() - 6 - 4);
+    appendLe32(out, crc32(raw));
+    appendLe32(out, static_cast<quint32>(raw.size()));
+    return out;
+}
+
+// The live segment's start time lives in "<path>.start" (ms since epoch):
+// birth time is unavailable on many filesystems, and falling back to the
+// open time would restart the age limit on every launch.
+static QString segmentStartPath(const QString &path) {
+    return path + QStringLiteral(".start");
+}
+
+static QDateTime readSegmentStart(const QString &path) {
+    QFile f(segmentStartPath(path));
+    if (!f.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    bool ok = false;
+    const qint64 ms = f.read(32).trimmed().toLongLong(&ok);
+    return ok && ms > 0 ? QDateTime::fromMSecsSinceEpoch(ms) : QDateTime();
+}
+
+static void writeSegmentStart(const QString &path, const QDateTime &start) {
+    QSaveFile f(segmentStartPath(path));
+    if (f.open(QIODevice::WriteOnly)) {
+        f.write(QByteArray::number(start.toMSecsSinceEpoch()) + '\n');
+        f.commit();
+    }
+}
+
+LogWriter::LogWriter(std::size_t capacity)
+    : m_ring(capacity) {
+    m_compressor = new QThreadPool();
+    m_compressor->setMaxThreadCount(1);
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName(QStringLiteral("LogWriter"));
+    m_thread->start(QThread::LowPriority);
+}
+
+LogWriter::~LogWriter() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_thread->wait(); // drains and flushes what is queued
+    delete m_thread;
+    delete m_compressor; // waits for a compression in progress
+}
+
+void LogWriter::setPath(const QString &path) {
+    {
+        std::lock_guard lock(m_mutex);
+        if (path == m_path) {
+            return;
+        }
+        m_path = path;
+        m_pathChanged = true;
+    }
+    m_wake.notify_one();
+}
+
+void LogWriter::wake() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_wakePending = true;
+    }
+    m_wake.notify_one();
+}
+
+bool LogWriter::append(QByteArray chunk) {
+    if (chunk.isEmpty()) {
+        return true;
+    }
+    for (int attempt = 0;; ++attempt) {
+        if (m_ring.tryPush(chunk)) {
+            break;
+        }
+        if (attempt == kPushRetries) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        // Full: make sure the writer is draining, then give it a moment.
+        if (attempt == 0) {
+            wake();
+        }
+        std::this_thread::yield();
+    }
+    m_enqueued.fetch_add(1, std::memory_order_relaxed);
+    // Wake the writer for the first chunk after it went idle, and again when
+    // the ring is half full; in between it batches on its own timer.
+    const std::size_t queued = m_ring.sizeApprox();
+    if (queued == 1 || queued == m_ring.capacity() / 2) {
+        wake();
+    }
+    return true;
+}
+
+void LogWriter::flush() {
+    std::unique_lock lock(m_mutex);
+    if (m_stopping) {
+        return;
+    }
+    const quint64 target = ++m_flushRequests;
+    m_wake.notify_one();
+    m_flushed.wait(lock, [this, target]() { return m_flushesDone >= target || m_stopping; });
+}
+
+void LogWriter::setRotation(const Rotation &rotation) {
+    std::lock_guard lock(m_mutex);
+    m_rotation = rotation;
+}
+
+QString LogWriter::archivePath(const QString &path, int generation) {
+    return path + QLatin1Char('.') + QString::number(generation) + QStringLiteral(".gz");
+}
+
+qint64 LogWriter::footprint(const QString &path) {
+    if (path.isEmpty()) {
+        return 0;
+    }
+    const QFileInfo info(path);
+    const QString base = info.fileName();
+    qint64 total = 0;
+    for (const QFileInfo &f : QDir(info.absolutePath()).entryInfoList({base + QLatin1Char('*')}, QDir::Files)) {
+        const QString name = f.fileName();
+        const QString rest = name.mid(base.size());
+        bool numbered = false;
+        if (rest.startsWith(QLatin1Char('.')) && rest.endsWith(QStringLiteral(".gz"))) {
+            rest.mid(1, rest.size() - 4).toInt(&numbered);
+        }
+        if (rest.isEmpty() || numbered || rest.startsWith(kSegmentInfix)) {
+            total += f.size();
+        }
+    }
+    return total;
+}
+
+void LogWriter::compressSegment(const QString &path, const QString &segment, int generations) {
+    if (generations <= 0) {
+        QFile::remove(segment);
+        for (int g = 1; QFile::exists(archivePath(path, g)); ++g) {
+            QFile::remove(archivePath(path, g));
+        }
+        return;
+    }
+    QFile in(segment);
+    if (!in.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    // The segment can be any size (no size limit, or a log from before
+    // rotation), so it is compressed a fixed-size block at a time, one gzip
+    // member each; gzip readers concatenate members. The result is staged
+    // as generation 0 and only shifted in once it is complete: on failure
+    // the raw segment stays and is retried on the next start.
+    const QString staged = archivePath(path, 0);
+    QSaveFile out(staged);
+    bool ok = out.open(QIODevice::WriteOnly);
+    while (ok && !in.atEnd()) {
+        const QByteArray block = in.read(kGzipMemberBytes);
+        const QByteArray gz = block.isEmpty() ? QByteArray() : gzipCompress(block);
+        ok = !gz.isEmpty() && out.write(gz) == gz.size();
+    }
+    in.close();
+    if (!ok || !out.commit()) {
+        qWarning("[log writer] cannot compress %s, keeping it uncompressed", qUtf8Printable(segment));
+        return; // an uncommitted QSaveFile discards its temp file
+    }
+
+    // Drop archives past the limit (it may have been lowered), then shift.
+    for (int g = generations; QFile::exists(archivePath(path, g)); ++g) {
+        QFile::remove(archivePath(path, g));
+    }
+    for (int g = generations - 1; g >= 1; --g) {
+        if (QFile::exists(archivePath(path, g))) {
+            QFile::rename(archivePath(path, g), archivePath(path, g + 1));
+        }
+    }
+    if (!QFile::rename(staged, archivePath(path, 1))) {
+        qWarning("[log writer] cannot write %s", qUtf8Printable(archivePath(path, 1)));
+        return;
+    }
+    QFile::remove(segment);
+}
+
+LogWriter::Stats LogWriter::stats() const {
+    Stats s;
+    s.enqueued = m_enqueued.load(std::memory_order_relaxed);
+    s.dropped = m_dropped.load(std::memory_order_relaxed);
+    s.bytesWritten = m_bytesWritten.load(std::memory_order_relaxed);
+    s.writes = m_writes.load(std::memory_order_relaxed);
+    s.rotations = m_rotations.load(std::memory_order_relaxed);
+    return s;
+}
+
+void LogWriter::run() {
+    using Clock = std::chrono::steady_clock;
+    QFile file; // only touched on this thread
+    QString path;
+    QByteArray buffer;
+    buffer.reserve(static_cast<qsizetype>(kBatchBytes));
+    Clock::time_point firstPending{};
+    quint64 reportedDrops = 0;
+    Rotation rotation;
+    qint64 segmentBytes = 0;
+    QDateTime segmentStart;
+
+    const auto openSegment = [&]() {
+        file.setFileName(path);
+        QDir().mkpath(QFileInfo(file).absolutePath());
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            // Chunks are discarded until the path changes again.
+            qWarning("[log writer] cannot open %s", qUtf8Printable(path));
+            return;
+        }
+        segmentBytes = file.size();
+        const QDateTime recorded = segmentBytes > 0 ? readSegmentStart(path) : QDateTime();
+        if (recorded.isValid()) {
+            segmentStart = recorded;
+            return;
+        }
+        // A log from before the sidecar existed: birth time is the best guess left.
+        const QDateTime born = QFileInfo(file).birthTime();
+        segmentStart = segmentBytes > 0 && born.isValid() ? born : QDateTime::currentDateTime();
+        writeSegmentStart(path, segmentStart);
+    };
+
+    const auto rotateIfDue = [&]() {
+        if (!file.isOpen() || segmentBytes == 0) {
+            return;
+        }
+        const bool tooBig = rotation.maxBytes > 0 && segmentBytes >= rotation.maxBytes;
+        const bool tooOld = rotation.maxAgeSecs > 0
+                && segmentStart.secsTo(QDateTime::currentDateTime()) >= rotation.maxAgeSecs;
+        if (!tooBig && !tooOld) {
+            return;
+        }
+        file.close();
+        const QString segment = path + kSegmentInfix + QString::number(QDateTime::currentMSecsSinceEpoch());
+        if (QFile::rename(path, segment)) {
+            const int generations = rotation.generations;
+            const QString livePath = path;
+            m_compressor->start([livePath, segment, generations]() {
+                compressSegment(livePath, segment, generations);
+            });
+            m_rotations.fetch_add(1, std::memory_order_relaxed);
+        }
+        openSegment();
+    };
+
+    const auto writeOut = [&]() {
+        if (buffer.isEmpty()) {
+            return;
+        }
+        if (file.isOpen()) {
+            const qint64 n = file.write(buffer);
+            file.flush();
+            if (n > 0) {
+                m_bytesWritten.fetch_add(static_cast<quint64>(n), std::memory_order_relaxed);
+                segmentBytes += n;
+            }
+            m_writes.fetch_add(1, std::memory_order_relaxed);
+        }
+        buffer.clear();
+        rotateIfDue();
+    };
+
+    std::unique_lock lock(m_mutex);
+    for (;;) {
+        // Idle: sleep until woken (the timeout only covers a wake-up lost to
+        // racing producers, and lets an idle segment age out). Holding data:
+        // until its batch window closes.
+        const auto timeout = buffer.isEmpty()
+                ? std::chrono::milliseconds(1000)
+                : std::chrono::duration_cast<std::chrono::milliseconds>(
+                        firstPending + std::chrono::milliseconds(kFlushIntervalMs) - Clock::now());
+        if (timeout.count() > 0) {
+            m_wake.wait_for(lock, timeout, [this]() {
+                return m_stopping || m_wakePending || m_pathChanged || m_flushRequests != m_flushesDone;
+            });
+        }
+        m_wakePending = false;
+        const bool stopping = m_stopping;
+        const bool pathChanged = m_pathChanged;
+        const QString newPath = m_path;
+        const quint64 flushTarget = m_flushRequests;
+        const bool flushRequested = flushTarget != m_flushesDone;
+        rotation = m_rotation;
+        m_pathChanged = false;
+        lock.unlock();
+
+        QByteArray chunk;
+        while (m_ring.tryPop(chunk)) {
+            if (buffer.isEmpty()) {
+                firstPending = Clock::now();
+            }
+            buffer += chunk;
+            if (static_cast<std::size_t>(buffer.size()) >= kBatchBytes) {
+                writeOut();
+            }
+        }
+        const quint64 dropped = m_dropped.load(std::memory_order_relaxed);
+        if (dropped != reportedDrops) {
+            if (buffer.isEmpty()) {
+                firstPending = Clock::now();
+            }
+            buffer += QByteArray("[log writer] ") + QByteArray::number(dropped - reportedDrops)
+                    + " chunk(s) dropped: queue full\n";
+            reportedDrops = dropped;
+        }
+
+        if (pathChanged) {
+            writeOut(); // queued lines still belong to the old file
+            file.close();
+            path = newPath;
+            if (!path.isEmpty()) {
+                // Segments a previous run renamed but never compressed.
+                const QFileInfo info(path);
+                const QString prefix = info.fileName() + kSegmentInfix;
+                for (const QFileInfo &f : QDir(info.absolutePath()).entryInfoList({prefix + QLatin1Char('*')},
+                             QDir::Files, QDir::Name)) {
+                    const QString segment = f.absoluteFilePath();
+                    const int generations = rotation.generations;
+                    m_compressor->start([path, segment, generations]() { compressSegment(path, segment, generations); });
+                }
+                openSegment();
+                rotateIfDue(); // an oversized file left by an earlier run
+            }
+        }
+        if (stopping || flushRequested || Clock::now() >= firstPending + std::chrono::milliseconds(kFlushIntervalMs)) {
+            writeOut();
+        }
+        if (buffer.isEmpty()) {
+            rotateIfDue(); // age limit on a quiet log
+        }
+
+        lock.lock();
+        if (flushRequested) {
+            m_flushesDone = flushTarget;
+            m_flushed.notify_all();
+        }
+        if (stopping) {
+            m_flushed.notify_all();
+            return;
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#include "RouteAggregator.h"
+
+#include <algorithm>
+
+// Bit `i` counted from the most significant end, i.e. the i-th bit of the prefix.
+static bool prefixBit(const Ipv4Route &r, int i) {
+    return (r.addr >> (31 - i)) & 1u;
+}
+
+static bool prefixBit(const Ipv6Route &r, int i) {
+    return (r.addr[i / 8] >> (7 - i % 8)) & 1u;
+}
+
+static Ipv4Route truncatedRoute(const Ipv4Route &r, int len) {
+    Ipv4Route out = r;
+    out.addr = len == 0 ? 0 : r.addr & (~quint32(0) << (32 - len));
+    out.len = static_cast<quint8>(len);
+    return out;
+}
+
+static Ipv6Route truncatedRoute(const Ipv6Route &r, int len) {
+    Ipv6Route out = r;
+    for (int b = 0; b < 16; ++b) {
+        const int bitsInByte = std::clamp(len - b * 8, 0, 8);
+        out.addr[b] &= bitsInByte == 0 ? 0 : static_cast<quint8>(0xFF << (8 - bitsInByte));
+    }
+    out.len = static_cast<quint8>(len);
+    return out;
+}
+
+template <typename Route>
+static bool routeContains(const Route &outer, const Route &inner) {
+    return outer.len <= inner.len && truncatedRoute(inner, outer.len) == outer;
+}
+
+template <typename Route>
+static void aggregateSorted(std::vector<Route> &routes) {
+    std::sort(routes.begin(), routes.end());
+    // Single pass with a stack: in sorted order a prefix can only be covered
+    // by, or be the right sibling of, the entry directly before it, and a
+    // merged parent can in turn only merge with its own left neighbour.
+    std::vector<Route> out;
+    out.reserve(routes.size());
+    for (const Route &r : routes) {
+        if (!out.empty() && routeContains(out.back(), r)) continue;
+        out.push_back(r);
+        while (out.size() >= 2) {
+            const Route &right = out[out.size() - 1];
+            const Route &left = out[out.size() - 2];
+            if (left.len != right.len || left.len == 0 || prefixBit(left, left.len - 1)) break;
+            const Route parent = truncatedRoute(left, left.len - 1);
+            if (!(truncatedRoute(right, right.len - 1) == parent)) break;
+            out.pop_back();
+            out.back() = parent;
+        }
+    }
+    routes.swap(out);
+}
+
+template <typename Route>
+static void truncateAndAggregate(std::vector<Route> &routes, int len) {
+    for (Route &r : routes) {
+        if (r.len > len) r = truncatedRoute(r, len);
+    }
+    aggregateSorted(routes);
+}
+
+template <typename Route>
+static void limitSorted(std::vector<Route> &routes, std::size_t maxRoutes, int maxLen) {
+    aggregateSorted(routes);
+    if (maxRoutes == 0 || routes.size() <= maxRoutes) return;
+    // Route count is monotonic in the truncation length, so binary search it.
+    int lo = 0;
+    int hi = maxLen;
+    std::vector<Route> probe;
+    while (lo < hi) {
+        const int mid = (lo + hi + 1) / 2;
+        probe = routes;
+        truncateAndAggregate(probe, mid);
+        if (probe.size() <= maxRoutes) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    truncateAndAggregate(routes, lo);
+}
+
+void aggregateRoutes(std::vector<Ipv4Route> &routes) {
+    aggregateSorted(routes);
+}
+
+void aggregateRoutes(std::vector<Ipv6Route> &routes) {
+    aggregateSorted(routes);
+}
+
+void limitRoutes(std::vector<Ipv4Route> &routes, std::size_t maxRoutes) {
+    limitSorted(routes, maxRoutes, 32);
+}
+
+void limitRoutes(std::vector<Ipv6Route> &routes, std::size_t maxRoutes) {
+    limitSorted(routes, maxRoutes, 128);
+}
+
+void limitRoutes(std::vector<Ipv4Route> &v4, std::vector<Ipv6Route> &v6, std::size_t maxRoutes) {
+    if (maxRoutes == 0 || v4.size() + v6.size() <= maxRoutes) return;
+    if (v6.size() >= maxRoutes) {
+        // Degenerate budget: split it evenly.
+        limitRoutes(v6, std::max<std::size_t>(1, maxRoutes / 2));
+    }
+    limitRoutes(v4, std::max<std::size_t>(1, maxRoutes - std::min(v6.size(), maxRoutes - 1)));
+}
@@ -0,0 +1,84 @@
+#include "RoutePrefix.h"
+
+#include <QHostAddress>
+#include <QString>
+#include <cstdio>
+
+static bool parsePrefixLen(std::string_view text, int maxLen, int &out) {
+    if (text.empty() || text.size() > 3) return false;
+    int v = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        v = v * 10 + (c - '0');
+    }
+    if (v > maxLen) return false;
+    out = v;
+    return true;
+}
+
+bool parseIpv4Route(std::string_view text, Ipv4Route &out) {
+    int len = 32;
+    const auto slash = text.find('/');
+    if (slash != std::string_view::npos) {
+        if (!parsePrefixLen(text.substr(slash + 1), 32, len)) return false;
+        text = text.substr(0, slash);
+    }
+    quint32 addr = 0;
+    int octets = 0;
+    std::size_t i = 0;
+    while (octets < 4) {
+        if (i >= text.size() || text[i] < '0' || text[i] > '9') return false;
+        int v = 0;
+        std::size_t digits = 0;
+        while (i < text.size() && text[i] >= '0' && text[i] <= '9') {
+            v = v * 10 + (text[i] - '0');
+            ++i;
+            if (++digits > 3 || v > 255) return false;
+        }
+        addr = (addr << 8) | static_cast<quint32>(v);
+        ++octets;
+        if (octets < 4) {
+            if (i >= text.size() || text[i] != '.') return false;
+            ++i;
+        }
+    }
+    if (i != text.size()) return false;
+    out.addr = len == 0 ? 0 : addr & (~quint32(0) << (32 - len));
+    out.len = static_cast<quint8>(len);
+    return true;
+}
+
+bool parseIpv6Route(std::string_view text, Ipv6Route &out) {
+    int len = 128;
+    const auto slash = text.find('/');
+    if (slash != std::string_view::npos) {
+        if (!parsePrefixLen(text.substr(slash + 1), 128, len)) return false;
+        text = text.substr(0, slash);
+    }
+    // IPv6 entries are rare in the lists we consume; defer to Qt's parser.
+    QHostAddress address;
+    if (!address.setAddress(QString::fromLatin1(text.data(), static_cast<int>(text.size())))
+            || address.protocol() != QAbstractSocket::IPv6Protocol) {
+        return false;
+    }
+    const Q_IPV6ADDR raw = address.toIPv6Address();
+    for (int b = 0; b < 16; ++b) {
+        const int bitsInByte = qBound(0, len - b * 8, 8);
+        const quint8 mask = bitsInByte == 0 ? 0 : static_cast<quint8>(0xFF << (8 - bitsInByte));
+        out.addr[b] = raw[b] & mask;
+    }
+    out.len = static_cast<quint8>(len);
+    return true;
+}
+
+std::string formatIpv4Route(const Ipv4Route &route) {
+    char buf[24];
+    const int n = std::snprintf(buf, sizeof(buf), "%u.%u.%u.%u/%u", (route.addr >> 24) & 0xFF,
+            (route.addr >> 16) & 0xFF, (route.addr >> 8) & 0xFF, route.addr & 0xFF, unsigned(route.len));
+    return std::string(buf, static_cast<std::size_t>(n));
+}
+
+std::string formatIpv6Route(const Ipv6Route &route) {
+    const QHostAddress address(route.addr);
+    return (address.toString() + '/' + QString::number(route.len)).toStdString();
+}
@@ -0,0 +1,253 @@
+#include "RoutingCache.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+#include "RouteAggregator.h"
+
+static constexpr char kMagic[4] = {'T', 'T', 'R', 'C'};
+static constexpr quint32 kFormatVersion = 3;
+
+struct CacheHeader {
+    char magic[4];
+    quint32 version;
+    quint64 sourceSize;
+    qint64 sourceMtimeMs;
+    quint32 v4Count;
+    quint32 v6Count;
+    quint32 checksum;
+    quint32 inputPrefixes;      ///< unique prefixes in the source, before aggregation
+    quint32 aggregatedPrefixes; ///< after lossless aggregation, before the route budget
+    quint32 reserved;
+};
+static_assert(sizeof(CacheHeader) == 48, "header size keeps the route arrays 8-byte aligned");
+
+static quint32 fnv1a(const uchar *data, std::size_t size, quint32 hash = 2166136261u) {
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static std::string_view trimmed(std::string_view s) {
+    while (!s.empty() && static_cast<unsigned char>(s.front()) <= ' ') s.remove_prefix(1);
+    while (!s.empty() && static_cast<unsigned char>(s.back()) <= ' ') s.remove_suffix(1);
+    return s;
+}
+
+RoutingCache::~RoutingCache() {
+    close();
+}
+
+void RoutingCache::parseList(const char *data, std::size_t size, std::vector<Ipv4Route> &v4,
+                             std::vector<Ipv6Route> &v6, CompileStats *stats) {
+    CompileStats local;
+    std::string_view rest(data, size);
+    while (!rest.empty()) {
+        const auto nl = rest.find('\n');
+        std::string_view line = trimmed(rest.substr(0, nl));
+        rest = nl == std::string_view::npos ? std::string_view() : rest.substr(nl + 1);
+        if (line.empty() || line.front() == '#') continue;
+        ++local.lines;
+        if (line.find(':') == std::string_view::npos) {
+            Ipv4Route r;
+            if (parseIpv4Route(line, r)) {
+                v4.push_back(r);
+                continue;
+            }
+        } else {
+            Ipv6Route r;
+            if (parseIpv6Route(line, r)) {
+                v6.push_back(r);
+                continue;
+            }
+        }
+        ++local.rejected;
+    }
+    std::sort(v4.begin(), v4.end());
+    v4.erase(std::unique(v4.begin(), v4.end()), v4.end());
+    std::sort(v6.begin(), v6.end());
+    v6.erase(std::unique(v6.begin(), v6.end()), v6.end());
+    local.v4 = v4.size();
+    local.v6 = v6.size();
+    if (stats) *stats = local;
+}
+
+// Each route budget compiles to its own file, so changing the budget would
+// leave the previous one behind for good. Only "<list>.max<digits>.bin" next
+// to the list is touched; a cache some other RoutingCache still maps is
+// unlinked on POSIX and skipped where the platform refuses.
+static void removeOtherLimitedCaches(const QString &sourcePath, const QString &keepPath) {
+    const QFileInfo source(sourcePath);
+    const QString prefix = source.fileName() + QStringLiteral(".max");
+    const QString keep = QFileInfo(keepPath).fileName();
+    QDir dir = source.absoluteDir();
+    const QStringList names = dir.entryList({prefix + QStringLiteral("*.bin")}, QDir::Files);
+    for (const QString &name : names) {
+        if (name == keep) {
+            continue;
+        }
+        const QStringView budget = QStringView(name).sliced(prefix.size(), name.size() - prefix.size() - 4);
+        if (!budget.isEmpty() && std::all_of(budget.begin(), budget.end(), [](QChar c) { return c.isDigit(); })) {
+            dir.remove(name);
+        }
+    }
+}
+
+bool RoutingCache::compile(const QString &sourcePath, const QString &cachePath, CompileStats *stats,
+                           QString *error, std::size_t maxRoutes) {
+    QFile src(sourcePath);
+    if (!src.open(QIODevice::ReadOnly)) {
+        if (error) *error = QString("cannot open %1: %2").arg(sourcePath, src.errorString());
+        return false;
+    }
+    const QFileInfo srcInfo(src);
+    std::vector<Ipv4Route> v4;
+    std::vector<Ipv6Route> v6;
+    if (src.size() > 0) {
+        // Map instead of readAll(): the list can be several MB and is scanned once.
+        if (uchar *mapped = src.map(0, src.size())) {
+            parseList(reinterpret_cast<const char *>(mapped), static_cast<std::size_t>(src.size()), v4, v6, stats);
+            src.unmap(mapped);
+        } else {
+            const QByteArray bytes = src.readAll();
+            parseList(bytes.constData(), static_cast<std::size_t>(bytes.size()), v4, v6, stats);
+        }
+    } else if (stats) {
+        *stats = CompileStats{};
+    }
+    const std::size_t inputPrefixes = v4.size() + v6.size();
+    aggregateRoutes(v4);
+    aggregateRoutes(v6);
+    const std::size_t aggregatedPrefixes = v4.size() + v6.size();
+    if (stats) {
+        stats->v4Aggregated = v4.size();
+        stats->v6Aggregated = v6.size();
+    }
+    if (maxRoutes > 0 && aggregatedPrefixes > maxRoutes) {
+        limitRoutes(v4, v6, maxRoutes);
+        if (stats) stats->limited = v4.size() + v6.size();
+    }
+
+    CacheHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.sourceSize = static_cast<quint64>(srcInfo.size());
+    header.sourceMtimeMs = srcInfo.lastModified().toMSecsSinceEpoch();
+    header.v4Count = static_cast<quint32>(v4.size());
+    header.v6Count = static_cast<quint32>(v6.size());
+    header.inputPrefixes = static_cast<quint32>(inputPrefixes);
+    header.aggregatedPrefixes = static_cast<quint32>(aggregatedPrefixes);
+    quint32 sum = fnv1a(reinterpret_cast<const uchar *>(v4.data()), v4.size() * sizeof(Ipv4Route));
+    header.checksum = fnv1a(reinterpret_cast<const uchar *>(v6.data()), v6.size() * sizeof(Ipv6Route), sum);
+
+    QDir().mkpath(QFileInfo(cachePath).absolutePath());
+    // QSaveFile renames into place on commit(), so a concurrent open() never
+    // maps a half-written cache.
+    QSaveFile out(cachePath);
+    if (!out.open(QIODevice::WriteOnly)) {
+        if (error) *error = QString("cannot write %1: %2").arg(cachePath, out.errorString());
+        return false;
+    }
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(v4.data()), static_cast<qint64>(v4.size() * sizeof(Ipv4Route)));
+    out.write(reinterpret_cast<const char *>(v6.data()), static_cast<qint64>(v6.size() * sizeof(Ipv6Route)));
+    if (!out.commit()) {
+        if (error) *error = QString("cannot write %1: %2").arg(cachePath, out.errorString());
+        return false;
+    }
+    if (maxRoutes > 0 && cachePath == compiledPathFor(sourcePath, maxRoutes)) {
+        removeOtherLimitedCaches(sourcePath, cachePath);
+    }
+    return true;
+}
+
+bool RoutingCache::open(const QString &cachePath, const QString &sourcePath) {
+    close();
+    m_file.setFileName(cachePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = QString("cannot open %1").arg(cachePath);
+        return false;
+    }
+    const qint64 size = m_file.size();
+    if (size < static_cast<qint64>(sizeof(CacheHeader))) {
+        m_error = "truncated header";
+        close();
+        return false;
+    }
+    uchar *data = m_file.map(0, size);
+    if (!data) {
+        m_error = QString("cannot map %1: %2").arg(cachePath, m_file.errorString());
+        close();
+        return false;
+    }
+    m_data = data;
+
+    CacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion) {
+        m_error = "unknown format";
+        close();
+        return false;
+    }
+    const QFileInfo srcInfo(sourcePath);
+    if (srcInfo.exists()
+            && (header.sourceSize != static_cast<quint64>(srcInfo.size())
+                || header.sourceMtimeMs != srcInfo.lastModified().toMSecsSinceEpoch())) {
+        m_error = "source list changed";
+        close();
+        return false;
+    }
+    const quint64 payload = quint64(header.v4Count) * sizeof(Ipv4Route) + quint64(header.v6Count) * sizeof(Ipv6Route);
+    if (payload != static_cast<quint64>(size) - sizeof(CacheHeader)) {
+        m_error = "size mismatch";
+        close();
+        return false;
+    }
+    const uchar *body = data + sizeof(CacheHeader);
+    if (fnv1a(body, static_cast<std::size_t>(payload)) != header.checksum) {
+        m_error = "checksum mismatch";
+        close();
+        return false;
+    }
+    m_v4 = reinterpret_cast<const Ipv4Route *>(body);
+    m_v4Count = header.v4Count;
+    m_v6 = reinterpret_cast<const Ipv6Route *>(body + m_v4Count * sizeof(Ipv4Route));
+    m_v6Count = header.v6Count;
+    m_inputPrefixes = header.inputPrefixes;
+    m_aggregatedPrefixes = header.aggregatedPrefixes;
+    m_error.clear();
+    return true;
+}
+
+void RoutingCache::close() {
+    if (m_data) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_v4 = nullptr;
+    m_v6 = nullptr;
+    m_v4Count = 0;
+    m_v6Count = 0;
+    m_inputPrefixes = 0;
+    m_aggregatedPrefixes = 0;
+}
+
+void RoutingCache::appendRoutes(std::vector<std::string> &out) const {
+    out.reserve(out.size() + m_v4Count + m_v6Count);
+    for (std::size_t i = 0; i < m_v4Count; ++i) {
+        out.push_back(formatIpv4Route(m_v4[i]));
+    }
+    for (std::size_t i = 0; i < m_v6Count; ++i) {
+        out.push_back(formatIpv6Route(m_v6[i]));
+    }
+}
@@ -0,0 +1,231 @@
+#include "RoutingListUpdater.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+#include <QThread>
+#include <memory>
+
+#include "RoutingCache.h"
+
+static constexpr int kTransferTimeoutMs = 60000;
+
+RoutingListUpdater::RoutingListUpdater(QObject *parent)
+    : QObject(parent)
+    , m_nam(new QNetworkAccessManager(this))
+{
+    m_timer.setTimerType(Qt::VeryCoarseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &RoutingListUpdater::refreshNow);
+}
+
+RoutingListUpdater::~RoutingListUpdater()
+{
+    if (m_reply) {
+        m_reply->disconnect(this);
+        m_reply->abort();
+    }
+    delete m_out; // uncommitted QSaveFile discards its temp file
+    // Compile workers are children: let them finish before they are deleted with us.
+    for (QThread *worker : findChildren<QThread *>(Qt::FindDirectChildrenOnly)) {
+        worker->wait();
+    }
+}
+
+void RoutingListUpdater::configure(const QString &url, const QString &cachePath, int intervalHours, int maxRoutes)
+{
+    m_url = url;
+    m_cachePath = cachePath;
+    m_intervalHours = qMax(0, intervalHours);
+    m_maxRoutes = qMax(0, maxRoutes);
+    loadValidators();
+    if (m_timer.isActive()) {
+        start();
+    }
+}
+
+void RoutingListUpdater::start()
+{
+    m_timer.stop();
+    if (m_url.isEmpty() || m_cachePath.isEmpty()) {
+        return;
+    }
+    if (m_intervalHours > 0) {
+        m_timer.start(m_intervalHours * 3600 * 1000);
+    }
+    const QFileInfo fi(m_cachePath);
+    const bool missing = !fi.exists() || fi.size() == 0;
+    const QDateTime checked = m_lastChecked.isValid() ? m_lastChecked : fi.lastModified();
+    const bool stale = m_intervalHours > 0
+            && checked.secsTo(QDateTime::currentDateTimeUtc()) >= qint64(m_intervalHours) * 3600;
+    if (missing || stale) {
+        refreshNow();
+    }
+}
+
+void RoutingListUpdater::stop()
+{
+    m_timer.stop();
+}
+
+void RoutingListUpdater::refreshNow()
+{
+    if (m_reply || m_url.isEmpty() || m_cachePath.isEmpty()) {
+        return;
+    }
+    QDir().mkpath(QFileInfo(m_cachePath).absolutePath());
+    m_out = new QSaveFile(m_cachePath);
+    if (!m_out->open(QIODevice::WriteOnly)) {
+        const QString error = m_out->errorString();
+        delete m_out;
+        m_out = nullptr;
+        emit finished(false, false, QStringLiteral("cannot write %1: %2").arg(m_cachePath, error));
+        return;
+    }
+    m_bytesReceived = 0;
+    m_writeFailed = false;
+
+    QNetworkRequest req(m_url);
+    req.setTransferTimeout(kTransferTimeoutMs);
+    req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    // Validators only make sense while we still hold the body they describe.
+    if (m_validatorsUrl == m_url && QFileInfo::exists(m_cachePath)) {
+        if (!m_etag.isEmpty()) {
+            req.setRawHeader("If-None-Match", m_etag.toUtf8());
+        }
+        if (!m_lastModified.isEmpty()) {
+            req.setRawHeader("If-Modified-Since", m_lastModified.toUtf8());
+        }
+    }
+    m_reply = m_nam->get(req);
+    connect(m_reply, &QNetworkReply::readyRead, this, &RoutingListUpdater::onReadyRead);
+    connect(m_reply, &QNetworkReply::finished, this, &RoutingListUpdater::onFinished);
+}
+
+void RoutingListUpdater::onReadyRead()
+{
+    // Stream straight to disk instead of buffering the whole list in memory.
+    const QByteArray chunk = m_reply->readAll();
+    if (m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
+        return;
+    }
+    m_bytesReceived += chunk.size();
+    if (!m_writeFailed && m_out->write(chunk) != chunk.size()) {
+        m_writeFailed = true;
+    }
+}
+
+void RoutingListUpdater::onFinished()
+{
+    QNetworkReply *reply = m_reply;
+    m_reply = nullptr;
+    reply->deleteLater();
+    std::unique_ptr<QSaveFile> out(m_out);
+    m_out = nullptr;
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() != QNetworkReply::NoError) {
+        out->cancelWriting();
+        emit finished(false, false, QStringLiteral("download failed: %1").arg(reply->errorString()));
+        return;
+    }
+    if (status == 304) {
+        out->cancelWriting();
+        m_lastChecked = QDateTime::currentDateTimeUtc();
+        saveValidators();
+        emit finished(true, false, QStringLiteral("not modified"));
+        return;
+    }
+    if (status != 200) {
+        out->cancelWriting();
+        emit finished(false, false, QStringLiteral("unexpected HTTP status %1").arg(status));
+        return;
+    }
+    onReadyRead();
+    if (m_writeFailed || m_bytesReceived == 0) {
+        out->cancelWriting();
+        emit finished(false, false, m_writeFailed ? QStringLiteral("cannot write %1").arg(m_cachePath)
+                                                  : QStringLiteral("server returned an empty list"));
+        return;
+    }
+    if (!out->commit()) {
+        emit finished(false, false, QStringLiteral("cannot replace %1: %2").arg(m_cachePath, out->errorString()));
+        return;
+    }
+    m_etag = QString::fromUtf8(reply->rawHeader("ETag"));
+    m_lastModified = QString::fromUtf8(reply->rawHeader("Last-Modified"));
+    m_validatorsUrl = m_url;
+    m_lastChecked = QDateTime::currentDateTimeUtc();
+    saveValidators();
+
+    // Rebuild the compiled cache off the GUI thread so the next connect only maps it.
+    struct Result {
+        bool ok = false;
+        RoutingCache::CompileStats stats;
+        QString error;
+    };
+    auto result = std::make_shared<Result>();
+    const QString source = m_cachePath;
+    const auto maxRoutes = static_cast<std::size_t>(m_maxRoutes);
+    QThread *worker = QThread::create([result, source, maxRoutes]() {
+        result->ok = RoutingCache::compile(source, RoutingCache::compiledPathFor(source), &result->stats,
+                                           &result->error);
+        if (result->ok && maxRoutes > 0) {
+            RoutingCache::CompileStats limitedStats;
+            result->ok = RoutingCache::compile(source, RoutingCache::compiledPathFor(source, maxRoutes),
+                                               &limitedStats, &result->error, maxRoutes);
+        }
+    });
+    worker->setParent(this);
+    const qint64 bytes = m_bytesReceived;
+    // Queued to this object: dropped automatically if the updater is gone by then.
+    connect(worker, &QThread::finished, this, [this, result, bytes]() {
+        if (!result->ok) {
+            emit finished(false, true, QStringLiteral("compile failed: %1").arg(result->error));
+            return;
+        }
+        emit finished(true, true, QStringLiteral("updated (%1 bytes, %2 -> %3 prefixes)")
+                                          .arg(bytes)
+                                          .arg(result->stats.v4 + result->stats.v6)
+                                          .arg(result->stats.v4Aggregated + result->stats.v6Aggregated));
+    });
+    connect(worker, &QThread::finished, worker, &QObject::deleteLater);
+    worker->start(QThread::LowPriority);
+}
+
+void RoutingListUpdater::loadValidators()
+{
+    m_etag.clear();
+    m_lastModified.clear();
+    m_validatorsUrl.clear();
+    m_lastChecked = QDateTime();
+    QFile f(metaPath());
+    if (!f.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const QJsonObject obj = QJsonDocument::fromJson(f.readAll()).object();
+    m_etag = obj.value("etag").toString();
+    m_lastModified = obj.value("last_modified").toString();
+    m_validatorsUrl = obj.value("url").toString();
+    m_lastChecked = QDateTime::fromString(obj.value("checked_at").toString(), Qt::ISODate);
+}
+
+void RoutingListUpdater::saveValidators() const
+{
+    QJsonObject obj;
+    obj.insert("url", m_validatorsUrl);
+    obj.insert("etag", m_etag);
+    obj.insert("last_modified", m_lastModified);
+    obj.insert("checked_at", m_lastChecked.toString(Qt::ISODate));
+    QSaveFile f(metaPath());
+    if (f.open(QIODevice::WriteOnly)) {
+        f.write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+        f.commit();
+    }
+}
@@ -0,0 +1,29 @@
+#include "TrafficCounters.h"
+
+#include <functional>
+#include <thread>
+
+std::size_t TrafficCounters::shardIndex() {
+    // Computed once per thread: core worker threads are long-lived, so the
+    // hash cost is paid on the first packet only.
+    thread_local const std::size_t idx = std::hash<std::thread::id>{}(std::this_thread::get_id()) % kShardCount;
+    return idx;
+}
+
+TrafficCounters::Snapshot TrafficCounters::snapshot() const {
+    Snapshot out;
+    for (const Shard &s : m_shards) {
+        out.rxBytes += s.rxBytes.load(std::memory_order_relaxed);
+        out.txBytes += s.txBytes.load(std::memory_order_relaxed);
+        out.rxPackets += s.rxPackets.load(std::memory_order_relaxed);
+    }
+    return out;
+}
+
+void TrafficCounters::reset() {
+    for (Shard &s : m_shards) {
+        s.rxBytes.store(0, std::memory_order_relaxed);
+        s.txBytes.store(0, std::memory_order_relaxed);
+        s.rxPackets.store(0, std::memory_order_relaxed);
+    }
+}
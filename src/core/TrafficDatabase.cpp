@@ -0,0 +1,382 @@
+#include "TrafficDatabase.h"
+
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QtEndian>
+#include <algorithm>
+#include <limits>
+#include <map>
+
+#include "ConfigStore.h"
+
+static constexpr char kMagic[4] = {'T', 'T', 'D', 'B'};
+static constexpr quint32 kVersion = 1;
+static constexpr qint64 kHeaderSize = 16;  // magic, version, record size, reserved
+static constexpr qint64 kRecordSize = 32;
+static constexpr qint64 kReadBatch = 4096; // records per read() in a scan
+
+static quint32 fnv1a(const uchar *data, qint64 size) {
+    quint32 h = 2166136261u;
+    for (qint64 i = 0; i < size; ++i) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+// Layout: u32 minute, u32 profile, u64 rx, u64 tx, u32 active secs, u32 FNV-1a of the first 28 bytes.
+static QByteArray encodeRecord(quint32 minute, quint32 profileId, quint64 rx, quint64 tx, quint32 activeSecs) {
+    QByteArray out(kRecordSize, '\0');
+    auto *p = reinterpret_cast<uchar *>(out.data());
+    qToLittleEndian<quint32>(minute, p);
+    qToLittleEndian<quint32>(profileId, p + 4);
+    qToLittleEndian<quint64>(rx, p + 8);
+    qToLittleEndian<quint64>(tx, p + 16);
+    qToLittleEndian<quint32>(activeSecs, p + 24);
+    qToLittleEndian<quint32>(fnv1a(p, 28), p + 28);
+    return out;
+}
+
+static bool decodeRecord(const uchar *p, TrafficDatabase::Record &r) {
+    if (qFromLittleEndian<quint32>(p + 28) != fnv1a(p, 28)) {
+        return false;
+    }
+    r.startMs = static_cast<qint64>(qFromLittleEndian<quint32>(p)) * TrafficDatabase::kIntervalMs;
+    r.profileId = qFromLittleEndian<quint32>(p + 4);
+    r.rxBytes = qFromLittleEndian<quint64>(p + 8);
+    r.txBytes = qFromLittleEndian<quint64>(p + 16);
+    r.activeSecs = qFromLittleEndian<quint32>(p + 24);
+    return true;
+}
+
+static bool readRecord(QFile &f, quint64 index, TrafficDatabase::Record &r) {
+    uchar buf[kRecordSize];
+    return f.seek(kHeaderSize + static_cast<qint64>(index) * kRecordSize)
+            && f.read(reinterpret_cast<char *>(buf), kRecordSize) == kRecordSize && decodeRecord(buf, r);
+}
+
+static QByteArray header() {
+    QByteArray out(kHeaderSize, '\0');
+    auto *p = reinterpret_cast<uchar *>(out.data());
+    std::copy(std::begin(kMagic), std::end(kMagic), out.begin());
+    qToLittleEndian<quint32>(kVersion, p + 4);
+    qToLittleEndian<quint32>(static_cast<quint32>(kRecordSize), p + 8);
+    return out;
+}
+
+QString TrafficDatabase::Profile::name() const {
+    const QString base = QFileInfo(path).completeBaseName();
+    return base.isEmpty() ? path : base;
+}
+
+TrafficDatabase::TrafficDatabase(QString dir)
+    : m_dir(std::move(dir))
+    , m_dataPath(m_dir + "/traffic.db") {
+    m_writer = new QThreadPool();
+    m_writer->setMaxThreadCount(1);
+    loadProfiles();
+    open();
+}
+
+TrafficDatabase::~TrafficDatabase() {
+    sync();
+    delete m_writer;
+}
+
+QString TrafficDatabase::defaultDir() {
+    return QFileInfo(storagePath()).absolutePath();
+}
+
+void TrafficDatabase::open() {
+    QDir().mkpath(m_dir);
+    QFile f(m_dataPath);
+    if (!f.open(QIODevice::ReadWrite)) {
+        qWarning("[traffic db] cannot open %s", qUtf8Printable(m_dataPath));
+        return;
+    }
+    if (f.size() >= kHeaderSize && f.read(kHeaderSize) != header()) {
+        // Unknown format: keep it for inspection and start over.
+        f.close();
+        QFile::remove(m_dataPath + ".corrupt");
+        QFile::rename(m_dataPath, m_dataPath + ".corrupt");
+        f.setFileName(m_dataPath);
+        if (!f.open(QIODevice::ReadWrite)) {
+            qWarning("[traffic db] cannot open %s", qUtf8Printable(m_dataPath));
+            return;
+        }
+    }
+    if (f.size() < kHeaderSize) {
+        f.resize(0);
+        f.write(header());
+    }
+
+    // Drop a partial record and any trailing records a crash left unreadable.
+    quint64 count = static_cast<quint64>((f.size() - kHeaderSize) / kRecordSize);
+    Record r;
+    while (count > 0 && !readRecord(f, count - 1, r)) {
+        --count;
+    }
+    if (f.size() != kHeaderSize + static_cast<qint64>(count) * kRecordSize) {
+        f.resize(kHeaderSize + static_cast<qint64>(count) * kRecordSize);
+    }
+    if (count > 0) {
+        m_lastQueuedMinute = static_cast<quint32>(r.startMs / kIntervalMs);
+    }
+
+    // Sparse index: the first readable record of every block.
+    std::lock_guard lock(m_mutex);
+    m_index.clear();
+    for (quint64 block = 0; block < count; block += kIndexStride) {
+        for (quint64 i = block; i < std::min(block + kIndexStride, count); ++i) {
+            if (readRecord(f, i, r)) {
+                m_index.push_back({static_cast<quint32>(r.startMs / kIntervalMs), i});
+                break;
+            }
+        }
+    }
+    m_recordCount = count;
+}
+
+void TrafficDatabase::loadProfiles() {
+    QFile f(m_dir + "/traffic_profiles.json");
+    if (!f.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const QJsonArray arr = QJsonDocument::fromJson(f.readAll()).object().value("profiles").toArray();
+    for (const QJsonValue &v : arr) {
+        const QJsonObject o = v.toObject();
+        Profile p;
+        p.id = static_cast<quint32>(o.value("id").toInteger());
+        p.path = o.value("path").toString();
+        if (p.id == 0 || p.path.isEmpty() || m_profileIds.contains(p.path)) {
+            continue;
+        }
+        m_profileIds.insert(p.path, p.id);
+        m_profiles.push_back(p);
+    }
+}
+
+void TrafficDatabase::saveProfiles() const {
+    QJsonArray arr;
+    for (const Profile &p : m_profiles) {
+        arr.append(QJsonObject{{"id", static_cast<qint64>(p.id)}, {"path", p.path}});
+    }
+    QSaveFile f(m_dir + "/traffic_profiles.json");
+    if (f.open(QIODevice::WriteOnly)) {
+        f.write(QJsonDocument(QJsonObject{{"profiles", arr}}).toJson(QJsonDocument::Indented));
+        f.commit();
+    }
+}
+
+quint32 TrafficDatabase::profileIdFor(const QString &configPath) {
+    const auto it = m_profileIds.constFind(configPath);
+    if (it != m_profileIds.constEnd()) {
+        return it.value();
+    }
+    quint32 id = 1;
+    for (const Profile &p : m_profiles) {
+        id = std::max(id, p.id + 1);
+    }
+    m_profiles.push_back({id, configPath});
+    m_profileIds.insert(configPath, id);
+    saveProfiles();
+    return id;
+}
+
+std::vector<TrafficDatabase::Profile> TrafficDatabase::profiles() const {
+    return m_profiles;
+}
+
+QString TrafficDatabase::profileName(quint32 id) const {
+    for (const Profile &p : m_profiles) {
+        if (p.id == id) {
+            return p.name();
+        }
+    }
+    return QStringLiteral("#%1").arg(id);
+}
+
+void TrafficDatabase::record(const QString &configPath, qint64 nowMs, quint64 rxBytes, quint64 txBytes,
+                             qint64 spanMs) {
+    if (configPath.isEmpty()) {
+        return;
+    }
+    const quint32 id = profileIdFor(configPath);
+    const quint32 minute = static_cast<quint32>(std::max<qint64>(0, nowMs) / kIntervalMs);
+    if (m_pending.valid && (m_pending.minute != minute || m_pending.profileId != id)) {
+        flush();
+    }
+    if (!m_pending.valid) {
+        m_pending.valid = true;
+        m_pending.minute = minute;
+        m_pending.profileId = id;
+    }
+    m_pending.rxBytes += rxBytes;
+    m_pending.txBytes += txBytes;
+    m_pending.activeMs += std::clamp<qint64>(spanMs, 0, kIntervalMs);
+}
+
+void TrafficDatabase::flush() {
+    if (m_pending.valid) {
+        append(m_pending);
+        m_pending = Pending{};
+    }
+}
+
+void TrafficDatabase::sync() {
+    flush();
+    m_writer->waitForDone();
+}
+
+void TrafficDatabase::append(const Pending &pending) {
+    // Keep the file sorted even if the wall clock stepped back.
+    const quint32 minute = std::max(pending.minute, m_lastQueuedMinute);
+    m_lastQueuedMinute = minute;
+    const QByteArray bytes = encodeRecord(minute, pending.profileId, pending.rxBytes, pending.txBytes,
+                                          static_cast<quint32>((pending.activeMs + 500) / 1000));
+    m_writer->start([this, bytes, minute]() {
+        quint64 index;
+        {
+            std::lock_guard lock(m_mutex);
+            index = m_recordCount;
+        }
+        // Written at its slot rather than with O_APPEND, so a failed write
+        // is simply overwritten by the next one.
+        QFile f(m_dataPath);
+        if (!f.open(QIODevice::ReadWrite) || !f.seek(kHeaderSize + static_cast<qint64>(index) * kRecordSize)
+            || f.write(bytes) != kRecordSize || !f.flush()) {
+            qWarning("[traffic db] cannot append to %s", qUtf8Printable(m_dataPath));
+            return;
+        }
+        std::lock_guard lock(m_mutex);
+        if (index % kIndexStride == 0) {
+            m_index.push_back({minute, index});
+        }
+        ++m_recordCount;
+    });
+}
+
+std::vector<TrafficDatabase::Record> TrafficDatabase::records(qint64 fromMs, qint64 toMs, quint32 profileId) const {
+    std::vector<Record> out;
+    m_writer->waitForDone();
+    quint64 first = 0;
+    quint64 count = 0;
+    {
+        std::lock_guard lock(m_mutex);
+        count = m_recordCount;
+        // Start at the last block that begins before the range: records of
+        // the range's first minute may sit at the end of it.
+        const quint32 fromMinute = static_cast<quint32>(std::clamp<qint64>(fromMs / kIntervalMs, 0,
+                std::numeric_limits<quint32>::max()));
+        const auto it = std::lower_bound(m_index.begin(), m_index.end(), fromMinute,
+                [](const IndexEntry &e, quint32 m) { return e.minute < m; });
+        first = it == m_index.begin() ? 0 : std::prev(it)->record;
+    }
+    const auto matches = [&](const Record &r) {
+        return r.startMs + kIntervalMs > fromMs && r.startMs < toMs && (profileId == 0 || r.profileId == profileId);
+    };
+
+    QFile f(m_dataPath);
+    if (count > first && f.open(QIODevice::ReadOnly) && f.seek(kHeaderSize + static_cast<qint64>(first) * kRecordSize)) {
+        QByteArray buf;
+        bool done = false;
+        for (quint64 i = first; i < count && !done;) {
+            const qint64 n = std::min<qint64>(kReadBatch, static_cast<qint64>(count - i));
+            buf = f.read(n * kRecordSize);
+            if (buf.size() != n * kRecordSize) {
+                break;
+            }
+            const auto *p = reinterpret_cast<const uchar *>(buf.constData());
+            for (qint64 k = 0; k < n; ++k) {
+                Record r;
+                if (!decodeRecord(p + k * kRecordSize, r)) {
+                    continue;
+                }
+                if (r.startMs >= toMs) {
+                    done = true;
+                    break;
+                }
+                if (matches(r)) {
+                    out.push_back(r);
+                }
+            }
+            i += static_cast<quint64>(n);
+        }
+    }
+    if (m_pending.valid) {
+        Record r;
+        r.startMs = static_cast<qint64>(std::max(m_pending.minute, m_lastQueuedMinute)) * kIntervalMs;
+        r.profileId = m_pending.profileId;
+        r.rxBytes = m_pending.rxBytes;
+        r.txBytes = m_pending.txBytes;
+        r.activeSecs = static_cast<quint32>((m_pending.activeMs + 500) / 1000);
+        if (matches(r)) {
+            out.push_back(r);
+        }
+    }
+    return out;
+}
+
+std::vector<TrafficDatabase::UsageRow> TrafficDatabase::usage(Granularity granularity, qint64 fromMs, qint64 toMs,
+                                                              quint32 profileId) const {
+    std::map<std::pair<qint64, quint32>, UsageRow> rows;
+    // Records are in time order, so the local-time period only has to be
+    // worked out again when a record falls past the current one.
+    qint64 periodStart = 0;
+    qint64 periodEnd = std::numeric_limits<qint64>::min();
+    for (const Record &r : records(fromMs, toMs, profileId)) {
+        if (granularity == Granularity::Minute) {
+            periodStart = r.startMs;
+        } else if (r.startMs >= periodEnd || r.startMs < periodStart) {
+            QDate date = QDateTime::fromMSecsSinceEpoch(r.startMs).date();
+            if (granularity == Granularity::Month) {
+                date = QDate(date.year(), date.month(), 1);
+            }
+            const QDate next = granularity == Granularity::Month ? date.addMonths(1) : date.addDays(1);
+            periodStart = date.startOfDay().toMSecsSinceEpoch();
+            periodEnd = next.startOfDay().toMSecsSinceEpoch();
+        }
+        UsageRow &row = rows[{periodStart, r.profileId}];
+        row.periodStartMs = periodStart;
+        row.profileId = r.profileId;
+        row.rxBytes += r.rxBytes;
+        row.txBytes += r.txBytes;
+        row.activeSecs += r.activeSecs;
+    }
+    std::vector<UsageRow> out;
+    out.reserve(rows.size());
+    for (const auto &entry : rows) {
+        out.push_back(entry.second);
+    }
+    return out;
+}
+
+bool TrafficDatabase::exportCsv(const QString &path, Granularity granularity, qint64 fromMs, qint64 toMs,
+                                quint32 profileId, QString *errorText) const {
+    const QString format = granularity == Granularity::Minute ? QStringLiteral("yyyy-MM-dd HH:mm")
+            : granularity == Granularity::Day                 ? QStringLiteral("yyyy-MM-dd")
+                                                              : QStringLiteral("yyyy-MM");
+    QByteArray csv = "period,profile,rx_bytes,tx_bytes,connected_secs\n";
+    for (const UsageRow &row : usage(granularity, fromMs, toMs, profileId)) {
+        QString name = profileName(row.profileId);
+        name.replace(QLatin1Char('"'), QStringLiteral("\"\""));
+        csv += QDateTime::fromMSecsSinceEpoch(row.periodStartMs).toString(format).toUtf8() + ",\"" + name.toUtf8()
+                + "\"," + QByteArray::number(row.rxBytes) + ',' + QByteArray::number(row.txBytes) + ','
+                + QByteArray::number(row.activeSecs) + '\n';
+    }
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly) || f.write(csv) != csv.size() || !f.commit()) {
+        if (errorText) {
+            *errorText = f.errorString();
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,147 @@
+#include "TrafficHistory.h"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr qint64 kMaxSpanMs = 3600 * 1000; // longer gaps (sleep) are squeezed into the last hour
+
+static qint64 alignDown(qint64 ms, qint64 step) {
+    const qint64 r = ms % step;
+    return r < 0 ? ms - r - step : ms - r;
+}
+
+void TrafficHistory::Histogram::add(quint64 value) {
+    int bin = 0;
+    if (value > 0) {
+        bin = 1 + static_cast<int>(std::log2(static_cast<double>(value)) * kBinsPerOctave);
+    }
+    ++counts[static_cast<std::size_t>(std::min(bin, kBins - 1))];
+    ++total;
+}
+
+quint64 TrafficHistory::Histogram::percentile(double q) const {
+    if (total == 0) {
+        return 0;
+    }
+    const quint32 rank = std::max<quint32>(1, static_cast<quint32>(std::ceil(q * total)));
+    quint32 seen = 0;
+    for (int bin = 0; bin < kBins; ++bin) {
+        seen += counts[static_cast<std::size_t>(bin)];
+        if (seen >= rank) {
+            // Bin b >= 1 holds [2^((b-1)/k), 2^(b/k)): report its upper edge.
+            return bin == 0 ? 0 : static_cast<quint64>(std::ceil(std::exp2(static_cast<double>(bin) / kBinsPerOctave)));
+        }
+    }
+    return 0;
+}
+
+TrafficHistory::TrafficHistory() {
+    for (int t = 0; t < TierCount; ++t) {
+        m_levels[t].ring.resize(kCapacity[t]);
+    }
+}
+
+const TrafficHistory::Bucket &TrafficHistory::at(Tier tier, std::size_t i) const {
+    const Level &level = m_levels[tier];
+    return level.ring[(level.head + i) % level.ring.size()];
+}
+
+const TrafficHistory::Bucket *TrafficHistory::find(Tier tier, qint64 startMs) const {
+    // Closed buckets are in start order, so the ring can be bisected.
+    std::size_t lo = 0;
+    std::size_t hi = size(tier);
+    while (lo < hi) {
+        const std::size_t mid = lo + (hi - lo) / 2;
+        if (at(tier, mid).startMs < startMs) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < size(tier) && at(tier, lo).startMs == startMs ? &at(tier, lo) : nullptr;
+}
+
+void TrafficHistory::addSample(qint64 endMs, quint64 rxBytes, quint64 txBytes, qint64 spanMs) {
+    spanMs = std::clamp<qint64>(spanMs, 1, kMaxSpanMs);
+    const qint64 startMs = endMs - spanMs;
+    // Integer shares of the cumulative overlap, so the totals add up exactly.
+    quint64 rxDone = 0;
+    quint64 txDone = 0;
+    for (qint64 t = startMs; t < endMs;) {
+        const qint64 second = alignDown(t, 1000);
+        const qint64 segmentEnd = std::min(second + 1000, endMs);
+        const double covered = static_cast<double>(segmentEnd - startMs) / static_cast<double>(spanMs);
+        const quint64 rxUpTo = segmentEnd == endMs ? rxBytes : static_cast<quint64>(std::llround(rxBytes * covered));
+        const quint64 txUpTo = segmentEnd == endMs ? txBytes : static_cast<quint64>(std::llround(txBytes * covered));
+        addToSecond(second, rxUpTo - rxDone, txUpTo - txDone);
+        rxDone = rxUpTo;
+        txDone = txUpTo;
+        t = segmentEnd;
+    }
+}
+
+void TrafficHistory::addToSecond(qint64 secondStartMs, quint64 rxBytes, quint64 txBytes) {
+    // A second is complete once a later one starts receiving bytes. If the
+    // wall clock went backwards, keep adding to the current second.
+    if (secondStartMs > m_secondStart) {
+        if (m_secondStart >= 0) {
+            foldSecond(m_secondStart, m_secondRx, m_secondTx);
+        }
+        m_secondStart = secondStartMs;
+        m_secondRx = 0;
+        m_secondTx = 0;
+    }
+    m_secondRx += rxBytes;
+    m_secondTx += txBytes;
+}
+
+void TrafficHistory::foldSecond(qint64 startMs, quint64 rxBytes, quint64 txBytes) {
+    for (int t = 0; t < TierCount; ++t) {
+        Level &level = m_levels[t];
+        const qint64 bucketStart = alignDown(startMs, kBucketMs[t]);
+        if (level.hasOpen && bucketStart > level.open.startMs) {
+            closeBucket(level);
+        }
+        if (!level.hasOpen) {
+            level.open = Bucket{};
+            level.open.startMs = bucketStart;
+            level.hasOpen = true;
+        }
+        Bucket &b = level.open;
+        b.rxBytes += rxBytes;
+        b.txBytes += txBytes;
+        b.rxMax = std::max(b.rxMax, rxBytes);
+        b.txMax = std::max(b.txMax, txBytes);
+        level.rxRates.add(rxBytes);
+        level.txRates.add(txBytes);
+    }
+}
+
+void TrafficHistory::closeBucket(Level &level) {
+    Bucket b = level.open;
+    b.rxP95 = std::min(level.rxRates.percentile(0.95), b.rxMax);
+    b.txP95 = std::min(level.txRates.percentile(0.95), b.txMax);
+    if (level.count == level.ring.size()) {
+        level.ring[level.head] = b;
+        level.head = (level.head + 1) % level.ring.size();
+    } else {
+        level.ring[(level.head + level.count) % level.ring.size()] = b;
+        ++level.count;
+    }
+    level.hasOpen = false;
+    level.rxRates = Histogram{};
+    level.txRates = Histogram{};
+}
+
+void TrafficHistory::clear() {
+    for (Level &level : m_levels) {
+        level.head = 0;
+        level.count = 0;
+        level.hasOpen = false;
+        level.rxRates = Histogram{};
+        level.txRates = Histogram{};
+    }
+    m_secondStart = -1;
+    m_secondRx = 0;
+    m_secondTx = 0;
+}
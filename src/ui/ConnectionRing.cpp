@@ -4,6 +4,7 @@
 #include <QPainterPath>
 #include <QMouseEvent>
 #include <QConicalGradient>
+#include <QEvent>
 #include <cmath>
 
 // ─── Colour palette ───
@@ -15,6 +16,24 @@ static const QColor kRed        {0xEF, 0x44, 0x44};       // error ring
 static const QColor kTextWhite  {0xEE, 0xEE, 0xEE};
 static const QColor kSubText    {0x94, 0xA3, 0xB8};
 
+/// Ring geometry shared by the cached layers and the animated arc.
+struct RingGeometry {
+    int side;
+    qreal penWidth;
+    QPointF centre;
+    QRectF ringRect;
+};
+
+static RingGeometry ringGeometry(const QSize &size) {
+    RingGeometry g;
+    g.side = qMin(size.width(), size.height());
+    const qreal ringSize = g.side * 0.82;
+    g.penWidth = g.side * 0.018;
+    g.centre = QPointF(size.width() / 2.0, size.height() / 2.0);
+    g.ringRect = QRectF(g.centre.x() - ringSize / 2.0, g.centre.y() - ringSize / 2.0, ringSize, ringSize);
+    return g;
+}
+
 ConnectionRing::ConnectionRing(QWidget *parent)
     : QWidget(parent)
 {
@@ -34,6 +53,8 @@ ConnectionRing::ConnectionRing(QWidget *parent)
 
 void ConnectionRing::setStatus(Status s) {
     m_status = s;
+    m_ringLayerDirty = true;
+    m_textLayerDirty = true;
     switch (s) {
     case Disconnected:   m_text = "Disconnected";   break;
     case Connecting:     m_text = "Connecting...";   break;
@@ -42,55 +63,96 @@ void ConnectionRing::setStatus(Status s) {
     case Disconnecting:  m_text = "Disconnecting...";break;
     case Error:          m_text = "Error";           break;
     }
-    if (s == Connecting || s == Reconnecting || s == Disconnecting) {
-        if (!m_animTimer.isActive()) {
+    if (animating()) {
+        if (!m_animTimer.isActive() && !m_paused) {
             m_elapsed.start();
             m_animTimer.start();
         }
     } else {
         m_animTimer.stop();
     }
-    update();
+    requestUpdate();
+}
+
+void ConnectionRing::setRenderingPaused(bool paused) {
+    if (paused == m_paused) {
+        return;
+    }
+    m_paused = paused;
+    if (paused) {
+        m_animTimer.stop();
+        return;
+    }
+    if (animating()) {
+        m_animTimer.start();
+    }
+    update(); // catch up on whatever changed while paused
+}
+
+void ConnectionRing::invalidateText() {
+    m_textLayerDirty = true;
+    requestUpdate();
+}
+
+void ConnectionRing::requestUpdate() {
+    if (!m_paused) {
+        update();
+    }
 }
 
 void ConnectionRing::setStatusText(const QString &text) {
+    if (m_text == text) {
+        return;
+    }
     m_text = text;
-    update();
+    invalidateText();
 }
 
 void ConnectionRing::setSubText(const QString &text) {
+    if (m_subText == text) {
+        return;
+    }
     m_subText = text;
-    update();
+    invalidateText();
 }
 
 void ConnectionRing::setTextColor(const QColor &color) {
+    if (m_textColor == color) {
+        return;
+    }
     m_textColor = color;
-    update();
+    invalidateText();
 }
 
 void ConnectionRing::setSubTextColor(const QColor &color) {
+    if (m_subTextColor == color) {
+        return;
+    }
     m_subTextColor = color;
-    update();
+    invalidateText();
 }
 
 // ─── painting ───────────────────────────────────────────────
 
-void ConnectionRing::paintEvent(QPaintEvent *) {
-    QPainter p(this);
-    p.setRenderHint(QPainter::Antialiasing, true);
+QPixmap ConnectionRing::makeLayer() const {
+    const qreal dpr = devicePixelRatioF();
+    QPixmap layer(size() * dpr);
+    layer.setDevicePixelRatio(dpr);
+    layer.fill(Qt::transparent);
+    return layer;
+}
 
-    const int side = qMin(width(), height());
-    const qreal ringSize = side * 0.82;
-    const qreal penWidth = side * 0.018;
-    const QPointF centre(width() / 2.0, height() / 2.0);
-    const QRectF ringRect(centre.x() - ringSize / 2.0, centre.y() - ringSize / 2.0,
-                          ringSize, ringSize);
+void ConnectionRing::renderRingLayer() {
+    m_ringLayer = makeLayer();
+    QPainter p(&m_ringLayer);
+    p.setRenderHint(QPainter::Antialiasing, true);
+    const RingGeometry g = ringGeometry(size());
 
     // ── outer glow (faint) ──
     if (m_status == Connected) {
-        QPen glowPen(kGreenDim, penWidth * 3.5, Qt::SolidLine, Qt::RoundCap);
+        QPen glowPen(kGreenDim, g.penWidth * 3.5, Qt::SolidLine, Qt::RoundCap);
         p.setPen(glowPen);
-        p.drawEllipse(ringRect);
+        p.drawEllipse(g.ringRect);
     }
 
     // ── ring ──
@@ -100,45 +162,94 @@ void ConnectionRing::paintEvent(QPaintEvent *) {
     case Error:          ringColor = kRed;     break;
     default:             ringColor = kGray;    break;
     }
+    QPen ringPen(ringColor, g.penWidth, Qt::SolidLine, Qt::RoundCap);
+    p.setPen(ringPen);
+    p.drawEllipse(g.ringRect);
+}
 
-    if (m_status == Connecting || m_status == Reconnecting || m_status == Disconnecting) {
-        // Draw an animated arc sweep
-        QConicalGradient grad(centre, -m_animAngle);
-        grad.setColorAt(0.0, kAccent);
-        grad.setColorAt(0.35, kAccent.darker(130));
-        grad.setColorAt(0.65, QColor(kAccent.red(), kAccent.green(), kAccent.blue(), 40));
-        grad.setColorAt(1.0, kAccent);
-        QPen arcPen(QBrush(grad), penWidth, Qt::SolidLine, Qt::RoundCap);
-        p.setPen(arcPen);
-        p.drawEllipse(ringRect);
-    } else {
-        QPen ringPen(ringColor, penWidth, Qt::SolidLine, Qt::RoundCap);
-        p.setPen(ringPen);
-        p.drawEllipse(ringRect);
-    }
+void ConnectionRing::renderTextLayer() {
+    m_textLayer = makeLayer();
+    QPainter p(&m_textLayer);
+    p.setRenderHint(QPainter::Antialiasing, true);
+    const RingGeometry g = ringGeometry(size());
 
     // ── status text ──
     {
         QFont f = font();
-        f.setPixelSize(static_cast<int>(side * 0.09));
+        f.setPixelSize(static_cast<int>(g.side * 0.09));
         f.setWeight(QFont::DemiBold);
         f.setLetterSpacing(QFont::AbsoluteSpacing, 0.5);
         p.setFont(f);
         p.setPen(m_textColor);
-        p.drawText(ringRect, Qt::AlignCenter, m_text);
+        p.drawText(g.ringRect, Qt::AlignCenter, m_text);
     }
 
     // ── sub text (below main text) ──
     if (!m_subText.isEmpty()) {
         QFont f = font();
-        f.setPixelSize(static_cast<int>(side * 0.05));
+        f.setPixelSize(static_cast<int>(g.side * 0.05));
         p.setFont(f);
         p.setPen(m_subTextColor);
-        QRectF subRect = ringRect.adjusted(0, side * 0.15, 0, 0);
+        QRectF subRect = g.ringRect.adjusted(0, g.side * 0.15, 0, 0);
         p.drawText(subRect, Qt::AlignHCenter | Qt::AlignCenter, m_subText);
     }
 }
 
+void ConnectionRing::paintEvent(QPaintEvent *) {
+    // A move to a screen with another scale factor leaves the layers stale.
+    if (m_textLayer.devicePixelRatio() != devicePixelRatioF()) {
+        m_ringLayerDirty = true;
+        m_textLayerDirty = true;
+    }
+    QPainter p(this);
+
+    if (animating()) {
+        // Only the rotating arc is drawn per frame.
+        const RingGeometry g = ringGeometry(size());
+        p.setRenderHint(QPainter::Antialiasing, true);
+        QConicalGradient grad(g.centre, -m_animAngle);
+        grad.setColorAt(0.0, kAccent);
+        grad.setColorAt(0.35, kAccent.darker(130));
+        grad.setColorAt(0.65, QColor(kAccent.red(), kAccent.green(), kAccent.blue(), 40));
+        grad.setColorAt(1.0, kAccent);
+        QPen arcPen(QBrush(grad), g.penWidth, Qt::SolidLine, Qt::RoundCap);
+        p.setPen(arcPen);
+        p.drawEllipse(g.ringRect);
+    } else {
+        if (m_ringLayerDirty) {
+            renderRingLayer();
+            m_ringLayerDirty = false;
+        }
+        p.drawPixmap(0, 0, m_ringLayer);
+    }
+
+    if (m_textLayerDirty) {
+        renderTextLayer();
+        m_textLayerDirty = false;
+    }
+    p.drawPixmap(0, 0, m_textLayer);
+}
+
+void ConnectionRing::resizeEvent(QResizeEvent *event) {
+    m_ringLayerDirty = true;
+    m_textLayerDirty = true;
+    QWidget::resizeEvent(event);
+}
+
+void ConnectionRing::changeEvent(QEvent *event) {
+    switch (event->type()) {
+    case QEvent::PaletteChange:
+    case QEvent::FontChange:
+    case QEvent::StyleChange:
+        m_ringLayerDirty = true;
+        m_textLayerDirty = true;
+        break;
+    default:
+        break;
+    }
+    QWidget::changeEvent(event);
+}
+
 void ConnectionRing::mousePressEvent(QMouseEvent *event) {
     if (event->button() == Qt::LeftButton) {
         // Check if click is inside the ring area
@@ -0,0 +1,222 @@
+#include "LogModel.h"
+
+#include <QBrush>
+#include <QColor>
+#include <QDateTime>
+#include <QString>
+#include <algorithm>
+
+LogLineStore::LogLineStore(std::size_t capacity, std::size_t maxPoolBytes)
+    : m_capacity(capacity < 1 ? 1 : capacity)
+    , m_maxPoolBytes(maxPoolBytes) {}
+
+std::size_t LogLineStore::pooledBytes(std::size_t textBytes) {
+    // Beyond the text: the QByteArray's heap header, terminator and malloc
+    // bookkeeping (~32 bytes), the pool slot, and a QHash node for the
+    // key/value pair, doubled for the table's spare capacity.
+    static constexpr std::size_t kOverhead = 32 + sizeof(PoolEntry) + 2 * (sizeof(QByteArray) + sizeof(quint32));
+    return textBytes + kOverhead;
+}
+
+quint32 LogLineStore::intern(const QByteArray &text) {
+    const auto it = m_ids.constFind(text);
+    if (it != m_ids.constEnd()) {
+        ++m_pool[it.value()].refs;
+        return it.value();
+    }
+    quint32 id;
+    if (!m_freeIds.empty()) {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+    } else {
+        id = static_cast<quint32>(m_pool.size());
+        m_pool.emplace_back();
+    }
+    m_pool[id].text = text;
+    m_pool[id].refs = 1;
+    m_ids.insert(text, id);
+    m_poolBytes += pooledBytes(static_cast<std::size_t>(text.size()));
+    return id;
+}
+
+void LogLineStore::release(quint32 id) {
+    PoolEntry &entry = m_pool[id];
+    if (--entry.refs > 0) {
+        return;
+    }
+    m_poolBytes -= pooledBytes(static_cast<std::size_t>(entry.text.size()));
+    m_ids.remove(entry.text);
+    entry.text = QByteArray();
+    m_freeIds.push_back(id);
+}
+
+void LogLineStore::popFront() {
+    release(m_lines[m_head].textId);
+    m_head = (m_head + 1) % m_lines.size();
+    --m_size;
+}
+
+void LogLineStore::dropFront(std::size_t count) {
+    for (std::size_t i = 0; i < count && m_size > 0; ++i) {
+        popFront();
+    }
+}
+
+std::size_t LogLineStore::evictionsFor(std::size_t lines, std::size_t textBytes) const {
+    std::size_t evict = m_size + lines > m_capacity ? m_size + lines - m_capacity : 0;
+    // Every incoming line is charged as a new entry, even if its text is pooled already.
+    std::size_t bytes = m_poolBytes + textBytes + lines * pooledBytes(0);
+    for (std::size_t i = 0; i < evict && i < m_size; ++i) {
+        const PoolEntry &entry = m_pool[at(i).textId];
+        bytes -= entry.refs == 1 ? pooledBytes(static_cast<std::size_t>(entry.text.size())) : 0;
+    }
+    // Shared text is only freed with its last line; counting it as kept
+    // makes this err on the side of evicting a little more.
+    while (bytes > m_maxPoolBytes && evict < m_size) {
+        const PoolEntry &entry = m_pool[at(evict).textId];
+        bytes -= entry.refs == 1 ? pooledBytes(static_cast<std::size_t>(entry.text.size())) : 0;
+        ++evict;
+    }
+    return std::min(evict, m_size);
+}
+
+std::size_t LogLineStore::push(qint64 timestampMs, LogLineLevel level, const QByteArray &text) {
+    std::size_t evicted = 0;
+    if (m_size == m_capacity) {
+        popFront();
+        ++evicted;
+    }
+    if (m_size == m_lines.size()) {
+        // Below capacity: grow the ring instead of evicting, so a quiet
+        // session doesn't pay for the full capacity up front.
+        std::rotate(m_lines.begin(), m_lines.begin() + static_cast<std::ptrdiff_t>(m_head), m_lines.end());
+        m_head = 0;
+        if (m_lines.size() == m_lines.capacity()) {
+            m_lines.reserve(std::min(m_capacity, std::max<std::size_t>(1024, m_lines.size() * 2)));
+        }
+        m_lines.emplace_back();
+    }
+    const quint32 id = intern(text);
+    m_lines[(m_head + m_size) % m_lines.size()] = LogLine{timestampMs, id, level};
+    ++m_size;
+    return evicted;
+}
+
+void LogLineStore::clear() {
+    m_lines = {};
+    m_head = 0;
+    m_size = 0;
+    m_pool.clear();
+    m_freeIds.clear();
+    m_ids.clear();
+    m_poolBytes = 0;
+}
+
+LogModel::LogModel(std::size_t capacity, std::size_t maxPoolBytes, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_store(capacity, maxPoolBytes) {
+    m_publishTimer.setSingleShot(true);
+    m_publishTimer.setInterval(kPublishIntervalMs);
+    connect(&m_publishTimer, &QTimer::timeout, this, &LogModel::publish);
+}
+
+void LogModel::append(LogLineLevel level, const QByteArray &chunk) {
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qsizetype start = 0;
+    while (start < chunk.size()) {
+        qsizetype end = chunk.indexOf('\n', start);
+        if (end < 0) {
+            end = chunk.size();
+        }
+        qsizetype len = end - start;
+        if (len > 0 && chunk.at(end - 1) == '\r') {
+            --len;
+        }
+        m_staged.push_back({now, level, chunk.mid(start, len)});
+        start = end + 1;
+    }
+    if (!m_publishTimer.isActive()) {
+        m_publishTimer.start();
+    }
+}
+
+void LogModel::publish() {
+    if (m_staged.empty()) {
+        return;
+    }
+    const std::size_t incoming = m_staged.size();
+    if (incoming >= m_store.capacity()) {
+        // The batch alone replaces everything on screen.
+        beginResetModel();
+        for (const StagedLine &line : m_staged) {
+            m_store.push(line.timestampMs, line.level, line.text);
+        }
+        m_store.dropFront(m_store.evictionsFor(0, 0));
+        endResetModel();
+        m_staged.clear();
+        return;
+    }
+
+    // Make room first (capacity and text budget) as one removal of the
+    // oldest rows, then append the batch as one insertion.
+    std::size_t incomingBytes = 0;
+    for (const StagedLine &line : m_staged) {
+        incomingBytes += static_cast<std::size_t>(line.text.size());
+    }
+    const std::size_t evict = m_store.evictionsFor(incoming, incomingBytes);
+    if (evict > 0) {
+        beginRemoveRows(QModelIndex(), 0, static_cast<int>(evict) - 1);
+        m_store.dropFront(evict);
+        endRemoveRows();
+    }
+    const int first = static_cast<int>(m_store.size());
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(incoming) - 1);
+    for (const StagedLine &line : m_staged) {
+        m_store.push(line.timestampMs, line.level, line.text);
+    }
+    endInsertRows();
+    m_staged.clear();
+}
+
+void LogModel::clear() {
+    m_publishTimer.stop();
+    beginResetModel();
+    m_staged.clear();
+    m_store.clear();
+    endResetModel();
+}
+
+QString LogModel::toPlainText() const {
+    QByteArray out;
+    for (std::size_t i = 0; i < m_store.size(); ++i) {
+        out += m_store.text(m_store.at(i));
+        out += '\n';
+    }
+    for (const StagedLine &line : m_staged) {
+        out += line.text;
+        out += '\n';
+    }
+    return QString::fromUtf8(out);
+}
+
+int LogModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_store.size());
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(m_store.size())) return {};
+    const LogLine &line = m_store.at(static_cast<std::size_t>(index.row()));
+    switch (role) {
+    case Qt::DisplayRole:
+        return QString::fromUtf8(m_store.text(line));
+    case Qt::ToolTipRole: // full text: long lines are elided in the view
+        return QDateTime::fromMSecsSinceEpoch(line.timestampMs).toString(QStringLiteral("yyyy-MM-dd HH:mm:ss.zzz  "))
+                + QString::fromUtf8(m_store.text(line));
+    case Qt::ForegroundRole:
+        if (line.level == LogLineLevel::Error) return QBrush(QColor(0xE0, 0x4F, 0x4F));
+        if (line.level == LogLineLevel::Warn) return QBrush(QColor(0xD0, 0x8A, 0x1C));
+        return {};
+    default:
+        return {};
+    }
+}
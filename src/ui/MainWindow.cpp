@@ -1,6 +1,7 @@
 #include "MainWindow.h"
 #include "ConfigWizard.h"
 #include "ConnectionRing.h"
+#include "RenderScheduler.h"
 #include "TrafficGraph.h"
 
 #include <QApplication>
@@ -13,7 +14,6 @@
 #include <QDialog>
 #include <QDialogButtonBox>
 #include <QDir>
-#include <QElapsedTimer>
 #include <QEvent>
 #include <QFile>
 #include <QFileDialog>
@@ -25,6 +25,7 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QRegularExpression>
+#include <QListView>
 #include <QListWidget>
 #include <QMainWindow>
 #include <QMenu>
@@ -35,6 +36,7 @@
 #include <QPainter>
 #include <QPixmap>
 #include <QScrollArea>
+#include <QScrollBar>
 #include <QSvgRenderer>
 #include <QProgressDialog>
 #include <QPushButton>
@@ -62,6 +64,10 @@
 #include <QToolButton>
 #include <QtGlobal>
 
+#include <algorithm>
+#include <memory>
+#include <atomic>
+#include <mutex>
 #include <thread>
 
 #include "common/logger.h"
@@ -81,9 +87,19 @@
 
 #include "AppSettings.h"
 #include "AppUiUtils.h"
+#include "ConfigCache.h"
 #include "ConfigInspector.h"
 #include "ConfigStore.h"
+#include "Format.h"
+#include "LogModel.h"
+#include "LogWriter.h"
+#include "RoutingCache.h"
+#include "RoutingListUpdater.h"
 #include "SettingsDialog.h"
+#include "TopTalkersDialog.h"
+#include "TrafficDatabase.h"
+#include "TrafficHistory.h"
+#include "UsageDialog.h"
 #include "UpdateChecker.h"
 #include "qt_trusttunnel_client.h"
 
@@ -98,11 +114,17 @@ static ag::LogLevel parseLogLevel(const QString &level) {
 
 class MainWindow : public QMainWindow {
 public:
+    ~MainWindow() override {
+        detachCoreLogger();
+        m_logSink->setView(nullptr); // a core thread may still be inside the old callback
+    }
+
     MainWindow() {
 #ifndef _WIN32
         m_isRoot = (::geteuid() == 0);
 #endif
         m_appSettings = loadAppSettings();
+        applyLogFileSettings();
 
         enforceFirstRunElevation();
 
@@ -234,48 +256,148 @@ private:
         return false;
     }
 
-    // Download routing list synchronously but process UI events during the
-    // wait so the window remains responsive and the progress dialog animates.
-    // The old implementation used QEventLoop::exec() which re-enters the event
-    // loop — a well-known source of subtle reentrancy bugs. This version
-    // uses a simple poll loop with processEvents() instead.
-    bool downloadRoutingList(const QString &url, const QString &targetPath) {
-        QNetworkAccessManager mgr;
-        QNetworkRequest req(url);
-        QNetworkReply *reply = mgr.get(req);
-
-        QElapsedTimer elapsed;
-        elapsed.start();
-        constexpr int TIMEOUT_MS = 8000;
-
-        while (!reply->isFinished()) {
-            if (elapsed.elapsed() >= TIMEOUT_MS) {
-                reply->abort();
-                log(tr("Routing download timed out"));
-                reply->deleteLater();
-                return false;
+    std::vector<std::string> customDnsServers() const {
+        std::vector<std::string> dnsServers;
+        if (m_appSettings.custom_dns_enabled) {
+            for (const auto &s : m_appSettings.custom_dns_servers) {
+                if (!s.trimmed().isEmpty()) {
+                    dnsServers.push_back(s.trimmed().toStdString());
+                }
             }
-            // Process GUI events briefly — keeps the progress dialog alive
-            // without re-entering a nested event loop.
-            qApp->processEvents(QEventLoop::AllEvents, 50);
         }
+        return dnsServers;
+    }
 
-        if (reply->error() != QNetworkReply::NoError) {
-            log(tr("Routing download failed: %1").arg(reply->errorString()));
-            reply->deleteLater();
-            return false;
+    // Domain bypass exclusions and traffic bypass rules from the settings,
+    // in the core's exclusion syntax.
+    std::vector<std::string> bypassExclusions(int *appliedCount = nullptr) {
+        int applied = 0;
+        std::vector<std::string> exclusions;
+
+        // Add domain bypass rules if enabled
+        if (m_appSettings.domain_bypass_enabled && !m_appSettings.domain_bypass_rules.isEmpty()) {
+            for (auto rule : m_appSettings.domain_bypass_rules) {
+                rule = rule.trimmed();
+                if (rule.isEmpty())
+                    continue;
+                // Auto-fix "*domain" → "*.domain" — the core requires a dot after wildcard.
+                if (rule.startsWith('*') && rule.size() > 1 && rule[1] != '.')
+                    rule.insert(1, '.');
+                exclusions.push_back(rule.toStdString());
+                ++applied;
+            }
+        }
+
+        // Add SSH bypass (port 22) if enabled.
+        // The core's exclusion syntax is `*:port` (wildcard port); see
+        // trusttunnel/README.md and core/src/domain_filter.cpp.
+        if (m_appSettings.ssh_bypass_enabled) {
+            exclusions.push_back("*:22");  // exclude destination port 22 (SSH)
+            ++applied;
+        }
+
+        // Add P2P bypass if enabled.
+        // The core supports only single wildcard ports (`*:port`), not
+        // ranges, so expand the BitTorrent default range 6881-6889
+        // explicitly. 6969 is the common BitTorrent tracker port.
+        if (m_appSettings.p2p_bypass_enabled) {
+            for (int port = 6881; port <= 6889; ++port) {
+                exclusions.push_back("*:" + std::to_string(port));
+                ++applied;
+            }
+            exclusions.push_back("*:6969");  // BitTorrent tracker
+            ++applied;
+        }
+
+        // Add user-specified bypass ports if enabled. Accepts single ports
+        // (`3389`) and ranges (`6881-6889`), separated by commas/spaces;
+        // each is expanded to the core's wildcard-port exclusion `*:port`.
+        if (m_appSettings.custom_ports_bypass_enabled
+                && !m_appSettings.custom_bypass_ports.trimmed().isEmpty()) {
+            const QStringList tokens = m_appSettings.custom_bypass_ports.split(
+                    QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts);
+            for (const QString &tok : tokens) {
+                int lo = -1, hi = -1;
+                const int dash = tok.indexOf('-');
+                if (dash > 0) {
+                    bool okLo = false, okHi = false;
+                    lo = tok.left(dash).toInt(&okLo);
+                    hi = tok.mid(dash + 1).toInt(&okHi);
+                    if (!okLo || !okHi) continue;
+                } else {
+                    bool ok = false;
+                    lo = hi = tok.toInt(&ok);
+                    if (!ok) continue;
+                }
+                if (lo > hi) { const int t = lo; lo = hi; hi = t; }
+                if (lo < 1 || hi > 65535) continue;
+                if (hi - lo > 1024) {  // guard against runaway ranges
+                    log(tr("Bypass port range too wide, skipped: %1").arg(tok));
+                    continue;
+                }
+                for (int port = lo; port <= hi; ++port) {
+                    exclusions.push_back("*:" + std::to_string(port));
+                    ++applied;
+                }
+            }
         }
-        QByteArray data = reply->readAll();
-        reply->deleteLater();
-        QFileInfo info(targetPath);
-        QDir().mkpath(info.absolutePath());
-        QFile f(targetPath);
-        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-            log(tr("Cannot write routing cache: %1").arg(targetPath));
-            return false;
+
+        if (appliedCount) *appliedCount = applied;
+        return exclusions;
+    }
+
+    // Re-evaluates routing/DNS/bypass settings against a running session and
+    // lets the client apply only what changed.
+    void applyRulesToRunningSession() {
+        const auto state = m_vpnClient->state();
+        if (state == QtTrustTunnelClient::State::Disconnected || state == QtTrustTunnelClient::State::Error
+                || state == QtTrustTunnelClient::State::Disconnecting) {
+            return; // the next connect builds everything from the settings anyway
+        }
+        QtTrustTunnelClient::RuleSet rules;
+        if (m_appSettings.routing_enabled) {
+            const QFileInfo fi(m_appSettings.routing_cache_path);
+            if (!fi.exists() || fi.size() == 0) {
+                // Applied from the updater's finished() once the list arrives.
+                m_routingUpdater->refreshNow();
+                return;
+            }
+            if (!prepareRoutingRules(rules.includedRoutes, rules.excludedRoutes)) {
+                return;
+            }
         }
-        f.write(data);
-        return true;
+        rules.dnsServers = customDnsServers();
+        rules.exclusions = bypassExclusions();
+        const QtTrustTunnelClient::RuleDelta delta = m_vpnClient->applyRules(rules);
+        if (delta.isEmpty()) {
+            log(tr("Routing rules unchanged, session kept"));
+            return;
+        }
+        log(tr("Routing changes: +%1/-%2 routes, +%3/-%4 bypass rules%5 (%6)")
+                    .arg(delta.routesAdded).arg(delta.routesRemoved)
+                    .arg(delta.exclusionsAdded).arg(delta.exclusionsRemoved)
+                    .arg(delta.dnsChanged ? tr(", DNS changed") : QString())
+                    .arg(delta.sessionRebuilt ? tr("tunnel rebuilt") : tr("applied on next connect")));
+    }
+
+    void applyRoutingRefreshSettings() {
+        if (!m_routingUpdater) return;
+        m_routingUpdater->configure(m_appSettings.routing_source_url, m_appSettings.routing_cache_path,
+                                    m_appSettings.routing_refresh_hours, static_cast<int>(routeBudget()));
+        if (m_appSettings.routing_enabled) {
+            m_routingUpdater->start();
+        } else {
+            m_routingUpdater->stop();
+        }
+    }
+
+    // Route budget the routing list is widened to. Supernets cover more than
+    // the list, which only tunnels a little extra in tunnel mode but would
+    // send extra traffic around the tunnel in bypass mode, so there the list
+    // is always applied exactly.
+    std::size_t routeBudget() const {
+        if (m_appSettings.routing_mode == "bypass_ru") return 0;
+        return static_cast<std::size_t>(std::max(0, m_appSettings.routing_max_routes));
     }
 
     bool prepareRoutingRules(std::vector<std::string> &includeOut, std::vector<std::string> &excludeOut) {
@@ -283,46 +405,47 @@ private:
             return true;
         }
         const QString cache = m_appSettings.routing_cache_path;
-        const QString url = m_appSettings.routing_source_url;
         QFileInfo fi(cache);
-        std::unique_ptr<QProgressDialog> routingProgress;
         if (!fi.exists() || fi.size() == 0) {
-            log(tr("Routing cache missing, downloading..."));
-            routingProgress = std::make_unique<QProgressDialog>(
-                    tr("Downloading routing list..."), QString(), 0, 0, this,
-                    Qt::Dialog | Qt::CustomizeWindowHint | Qt::WindowTitleHint);
-            routingProgress->setWindowModality(Qt::ApplicationModal);
-            routingProgress->setAutoClose(true);
-            routingProgress->setMinimumDuration(0);
-            routingProgress->setRange(0, 0);
-            routingProgress->show();
-            qApp->processEvents(QEventLoop::AllEvents, 50);
-            if (!downloadRoutingList(url, cache)) {
-                QMessageBox::warning(this, tr("Routing"),
-                        tr("Failed to download routing list.\nCheck connection and try again."));
-                if (routingProgress) routingProgress->close();
+            // Never download on the connect path: let the background updater
+            // fetch the list and resume the connect once it lands.
+            log(tr("Routing cache missing, downloading in background..."));
+            statusBar()->showMessage(tr("Downloading routing list..."));
+            m_connectAfterRoutingUpdate = true;
+            m_routingUpdater->refreshNow();
+            return false;
+        }
+        // The text list is only parsed when it changed since the last compile;
+        // otherwise the prefixes, already limited to the budget, come straight
+        // from the mapped binary cache.
+        const std::size_t budget = routeBudget();
+        const QString compiled = RoutingCache::compiledPathFor(cache, budget);
+        RoutingCache routes;
+        if (!routes.open(compiled, cache)) {
+            RoutingCache::CompileStats stats;
+            QString error;
+            if (!RoutingCache::compile(cache, compiled, &stats, &error, budget) || !routes.open(compiled, cache)) {
+                log(tr("Failed to compile routing cache: %1").arg(error.isEmpty() ? routes.errorString() : error));
                 return false;
             }
-            log(tr("Routing list cached to %1").arg(cache));
-            if (routingProgress) routingProgress->close();
-        }
-        QFile f(cache);
-        if (!f.open(QIODevice::ReadOnly)) {
-            log(tr("Failed to open routing cache: %1").arg(cache));
-            return false;
+            log(tr("Routing list compiled: %1 lines, %2 IPv4 + %3 IPv6 unique prefixes, %4 rejected")
+                        .arg(stats.lines).arg(stats.v4).arg(stats.v6).arg(stats.rejected));
         }
         includeOut.clear();
         excludeOut.clear();
-        while (!f.atEnd()) {
-            const QByteArray line = f.readLine();
-            QString s = QString::fromUtf8(line).trimmed();
-            if (s.isEmpty() || s.startsWith('#')) continue;
-            if (m_appSettings.routing_mode == "bypass_ru") {
-                excludeOut.emplace_back(s.toStdString());
-            } else {
-                includeOut.emplace_back(s.toStdString());
-            }
-        }
+        std::vector<std::string> &target = m_appSettings.routing_mode == "bypass_ru" ? excludeOut : includeOut;
+        const std::size_t aggregated = routes.aggregatedPrefixCount();
+        const std::size_t written = routes.v4Count() + routes.v6Count();
+        log(tr("Routing prefixes aggregated: %1 -> %2").arg(routes.inputPrefixCount()).arg(aggregated));
+        if (written < aggregated) {
+            log(tr("Routing prefixes limited to %1 (budget %2)").arg(written).arg(budget));
+        } else if (budget == 0 && m_appSettings.routing_max_routes > 0
+                   && aggregated > static_cast<std::size_t>(m_appSettings.routing_max_routes)) {
+            log(tr("Warning: %1 bypass routes exceed the budget of %2; applied exactly, since widening them "
+                   "would route extra traffic around the tunnel")
+                        .arg(aggregated).arg(m_appSettings.routing_max_routes));
+        }
+        routes.appendRoutes(target);
         const int count = static_cast<int>(includeOut.size() + excludeOut.size());
         log(tr("Routing rules loaded: %1 entries").arg(count));
         return true;
@@ -426,6 +549,8 @@ private:
         m_toggleLogsAction = viewMenu->addAction("Hide Logs");
         m_toggleLogsAction->setCheckable(true);
         m_toggleLogsAction->setChecked(true);
+        m_topTalkersAction = viewMenu->addAction("Top Talkers");
+        m_usageAction = viewMenu->addAction("Traffic Usage");
 
         m_languageMenu = menuBar()->addMenu("Language");
         auto *languageMenu = m_languageMenu;
@@ -510,6 +635,7 @@ private:
         // Traffic graph
         m_trafficGraph = new TrafficGraph(homePage);
         m_trafficGraph->setFixedHeight(70);
+        m_trafficGraph->setHistory(&m_trafficHistory);
         m_trafficGraph->setVisible(m_appSettings.show_traffic_graph);
         homeLayout->addWidget(m_trafficGraph);
 
@@ -601,10 +727,27 @@ private:
         m_logsPageTitle = logsTitleLabel;
         logsLayout->addWidget(logsTitleLabel);
 
-        m_logView = new QTextEdit(logsPage);
-        m_logView->setReadOnly(true);
-        m_logView->setTextInteractionFlags(Qt::TextSelectableByMouse | Qt::TextSelectableByKeyboard);
+        // Model/view over a bounded ring of log lines: uniform row heights
+        // keep layout and scrolling proportional to the visible rows.
+        m_logModel = new LogModel(1000000, 64 * 1024 * 1024, this);
+        m_logView = new QListView(logsPage);
+        m_logView->setObjectName("logView");
+        m_logView->setModel(m_logModel);
+        m_logView->setUniformItemSizes(true);
+        m_logView->setLayoutMode(QListView::SinglePass);
+        m_logView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+        m_logView->setEditTriggers(QAbstractItemView::NoEditTriggers);
         m_logView->setContextMenuPolicy(Qt::NoContextMenu);
+        // Follow the tail only while the user is already at the bottom.
+        connect(m_logModel, &QAbstractItemModel::rowsAboutToBeInserted, this, [this]() {
+            const QScrollBar *bar = m_logView->verticalScrollBar();
+            m_logFollowTail = bar->value() >= bar->maximum();
+        });
+        connect(m_logModel, &QAbstractItemModel::rowsInserted, this, [this]() {
+            if (m_logFollowTail) {
+                m_logView->scrollToBottom();
+            }
+        });
         logsLayout->addWidget(m_logView, 1);
 
         auto *logsBtnRow = new QHBoxLayout();
@@ -617,7 +760,7 @@ private:
 
         m_clearLogsBtn = new QPushButton(tr("Clear"), logsPage);
         m_clearLogsBtn->setObjectName("logsButton");
-        connect(m_clearLogsBtn, &QPushButton::clicked, this, [this]() { m_logView->clear(); });
+        connect(m_clearLogsBtn, &QPushButton::clicked, this, [this]() { m_logModel->clear(); });
         logsBtnRow->addWidget(m_clearLogsBtn);
 
         logsBtnRow->addStretch();
@@ -686,14 +829,33 @@ private:
         // ── VPN Client ──
         m_vpnClient = new QtTrustTunnelClient(this);
         m_vpnClient->setLogLevel(m_appSettings.log_level);
+        // Nothing deletes the main window at exit, and disconnectVpn() only
+        // queues the teardown, so every quit path (tray Exit, relaunch
+        // elevated, installer) finishes it here before the event loop returns.
+        connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+            m_statsTimer.stop();
+            m_vpnClient->shutdown(); // still logs: detach the core logger only afterwards
+            detachCoreLogger();
+            m_logSink->writer.flush();
+            m_trafficDb.sync(); // the window is never destroyed, so this keeps the open minute
+        });
 
         const ag::LogLevel uiLogLevel = parseLogLevel(m_appSettings.log_level);
-        ag::Logger::set_callback([this, uiLogLevel](ag::LogLevel level, std::string_view msg) {
+        // The callback holds its own reference to the sink and nothing of the
+        // window: a core thread may still be inside it while the window is
+        // being torn down, and the sink drops view updates once it's gone.
+        m_logSink->setView(m_logModel);
+        ag::Logger::set_callback([uiLogLevel, sink = m_logSink](ag::LogLevel level, std::string_view msg) {
             if (level > uiLogLevel) return;
-            const QString line = QString::fromUtf8(msg.data(), static_cast<int>(msg.size()));
-            QMetaObject::invokeMethod(this, [this, line]() {
-                log(QStringLiteral("[core] ") + line);
-            }, Qt::QueuedConnection);
+            // The file gets the line straight from the core thread; only the
+            // log view needs the GUI thread.
+            QByteArray chunk = QByteArrayLiteral("[core] ");
+            chunk.append(msg.data(), static_cast<qsizetype>(msg.size()));
+            chunk.append('\n');
+            sink->append(chunk);
+            const auto lineLevel = static_cast<LogLineLevel>(std::clamp(static_cast<int>(level),
+                    static_cast<int>(LogLineLevel::Error), static_cast<int>(LogLineLevel::Trace)));
+            sink->appendToView(lineLevel, chunk);
         });
 
         // Icon assignments (will be properly colored in recolorIcons via applyTheme)
@@ -738,10 +900,32 @@ private:
 
         connect(m_toggleLogsAction, &QAction::toggled, this, syncLogsVisibility);
 
+        connect(m_topTalkersAction, &QAction::triggered, this, [this]() {
+            if (!m_topTalkersDialog) {
+                m_topTalkersDialog = new TopTalkersDialog(m_currentLang, &m_flowTable,
+                                                          &m_vpnClient->connectionEvents(), this);
+                m_topTalkersDialog->setAttribute(Qt::WA_DeleteOnClose);
+            }
+            m_topTalkersDialog->show();
+            m_topTalkersDialog->raise();
+            m_topTalkersDialog->activateWindow();
+        });
+
+        connect(m_usageAction, &QAction::triggered, this, [this]() {
+            if (!m_usageDialog) {
+                m_usageDialog = new UsageDialog(m_currentLang, &m_trafficDb, this);
+                m_usageDialog->setAttribute(Qt::WA_DeleteOnClose);
+            }
+            m_usageDialog->show();
+            m_usageDialog->raise();
+            m_usageDialog->activateWindow();
+        });
+
         // Ring click toggles VPN
         connect(m_ring, &ConnectionRing::clicked, this, [this]() {
             const auto s = m_vpnClient->state();
-            if (s == QtTrustTunnelClient::State::Disconnected || s == QtTrustTunnelClient::State::Error) {
+            if (s == QtTrustTunnelClient::State::Disconnected || s == QtTrustTunnelClient::State::Error
+                    || s == QtTrustTunnelClient::State::Disconnecting) {
                 m_connectButton->click();
             } else {
                 m_disconnectButton->click();
@@ -802,6 +986,28 @@ private:
             log(tr("Update check: %1").arg(msg));
         });
 
+        // --- Routing list refresh ---
+        m_routingUpdater = new RoutingListUpdater(this);
+        connect(m_routingUpdater, &RoutingListUpdater::finished, this,
+                [this](bool ok, bool changed, const QString &message) {
+            log(tr("Routing list refresh: %1").arg(message));
+            if (!m_connectAfterRoutingUpdate) {
+                if (ok && changed) {
+                    applyRulesToRunningSession();
+                }
+                return;
+            }
+            m_connectAfterRoutingUpdate = false;
+            if (ok) {
+                m_connectButton->click();
+            } else {
+                statusBar()->showMessage(tr("Routing update failed"), 3000);
+                QMessageBox::warning(this, tr("Routing"),
+                        tr("Failed to download routing list.\nCheck connection and try again."));
+            }
+        });
+        applyRoutingRefreshSettings();
+
         // Check for updates 3 seconds after startup (non-blocking)
         QTimer::singleShot(3000, this, [this]() {
             m_updateChecker->checkNow();
@@ -923,6 +1129,14 @@ private:
 
         connect(m_connectButton, &QPushButton::clicked, this, [this]() {
             const auto s = m_vpnClient->state();
+            if (s == QtTrustTunnelClient::State::Disconnecting) {
+                // The old session is released off the GUI thread; pick this up once it's gone.
+                log(tr("Connect queued until the previous session is closed"));
+                connect(m_vpnClient, &QtTrustTunnelClient::teardownFinished, m_connectButton, &QPushButton::click,
+                        Qt::SingleShotConnection);
+                m_connectButton->setEnabled(false);
+                return;
+            }
             if (s != QtTrustTunnelClient::State::Disconnected && s != QtTrustTunnelClient::State::Error) {
                 log(tr("Connect ignored: state=%1").arg(static_cast<int>(s)));
                 return;
@@ -932,12 +1146,20 @@ private:
                 return;
             }
             // reset counters on a fresh session
+            m_vpnClient->resetTrafficCounters();
             m_bytesRx = 0;
             m_bytesTx = 0;
             m_lastGraphRx = 0;
             m_lastGraphTx = 0;
+            m_lastGraphSampleMs = 0;
             m_trafficGraph->reset();
-            m_loggedConnectionInfos.clear();
+            drainConnectionEvents(); // log what the previous session left queued
+            m_loggedConnectionKeys.clear();
+            m_flowTable.clear();
+            // The old core client may still be shutting down and pushing; the
+            // new generation makes drain() drop those events.
+            m_vpnClient->connectionEvents().resetDomains();
+            m_connectionDrainTimer.start();
             statusBar()->showMessage(tr("Preparing routing rules..."), 1500);
 #ifndef _WIN32
             if (!m_isRoot) {
@@ -949,7 +1171,9 @@ private:
             std::vector<std::string> includeRoutes;
             std::vector<std::string> excludeRoutes;
             if (!prepareRoutingRules(includeRoutes, excludeRoutes)) {
-                statusBar()->showMessage(tr("Routing update failed"), 3000);
+                if (!m_connectAfterRoutingUpdate) {
+                    statusBar()->showMessage(tr("Routing update failed"), 3000);
+                }
                 return;
             }
             statusBar()->showMessage(tr("Routing rules ready"), 1500);
@@ -957,101 +1181,22 @@ private:
                 statusBar()->showMessage(tr("Config load failed"), 3000);
                 return;
             }
+            m_sessionConfigPath = m_configPath->text();
             m_vpnClient->setRoutingRules(includeRoutes, excludeRoutes);
 
-            // Apply custom DNS if enabled
-            if (m_appSettings.custom_dns_enabled && !m_appSettings.custom_dns_servers.isEmpty()) {
-                std::vector<std::string> dnsServers;
-                for (const auto &s : m_appSettings.custom_dns_servers) {
-                    if (!s.trimmed().isEmpty()) {
-                        dnsServers.push_back(s.trimmed().toStdString());
-                    }
-                }
-                if (!dnsServers.empty()) {
-                    m_vpnClient->setCustomDns(dnsServers);
-                    log(tr("Custom DNS applied: %1 server(s)").arg(dnsServers.size()));
-                }
+            const std::vector<std::string> dnsServers = customDnsServers();
+            m_vpnClient->setCustomDns(dnsServers);
+            if (!dnsServers.empty()) {
+                log(tr("Custom DNS applied: %1 server(s)").arg(dnsServers.size()));
             }
 
-            // Apply domain bypass exclusions and traffic bypass rules
-            std::vector<std::string> exclusions;
             int appliedCount = 0;
-
-            // Add domain bypass rules if enabled
-            if (m_appSettings.domain_bypass_enabled && !m_appSettings.domain_bypass_rules.isEmpty()) {
-                for (auto rule : m_appSettings.domain_bypass_rules) {
-                    rule = rule.trimmed();
-                    if (rule.isEmpty())
-                        continue;
-                    // Auto-fix "*domain" → "*.domain" — the core requires a dot after wildcard.
-                    if (rule.startsWith('*') && rule.size() > 1 && rule[1] != '.')
-                        rule.insert(1, '.');
-                    exclusions.push_back(rule.toStdString());
-                    appliedCount++;
-                }
-            }
-
-            // Add SSH bypass (port 22) if enabled.
-            // The core's exclusion syntax is `*:port` (wildcard port); see
-            // trusttunnel/README.md and core/src/domain_filter.cpp.
-            if (m_appSettings.ssh_bypass_enabled) {
-                exclusions.push_back("*:22");  // exclude destination port 22 (SSH)
-                appliedCount++;
-            }
-
-            // Add P2P bypass if enabled.
-            // The core supports only single wildcard ports (`*:port`), not
-            // ranges, so expand the BitTorrent default range 6881-6889
-            // explicitly. 6969 is the common BitTorrent tracker port.
-            if (m_appSettings.p2p_bypass_enabled) {
-                for (int port = 6881; port <= 6889; ++port) {
-                    exclusions.push_back("*:" + std::to_string(port));
-                    appliedCount++;
-                }
-                exclusions.push_back("*:6969");  // BitTorrent tracker
-                appliedCount++;
-            }
-
-            // Add user-specified bypass ports if enabled. Accepts single ports
-            // (`3389`) and ranges (`6881-6889`), separated by commas/spaces;
-            // each is expanded to the core's wildcard-port exclusion `*:port`.
-            if (m_appSettings.custom_ports_bypass_enabled
-                    && !m_appSettings.custom_bypass_ports.trimmed().isEmpty()) {
-                const QStringList tokens = m_appSettings.custom_bypass_ports.split(
-                        QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts);
-                for (const QString &tok : tokens) {
-                    int lo = -1, hi = -1;
-                    const int dash = tok.indexOf('-');
-                    if (dash > 0) {
-                        bool okLo = false, okHi = false;
-                        lo = tok.left(dash).toInt(&okLo);
-                        hi = tok.mid(dash + 1).toInt(&okHi);
-                        if (!okLo || !okHi) continue;
-                    } else {
-                        bool ok = false;
-                        lo = hi = tok.toInt(&ok);
-                        if (!ok) continue;
-                    }
-                    if (lo > hi) { const int t = lo; lo = hi; hi = t; }
-                    if (lo < 1 || hi > 65535) continue;
-                    if (hi - lo > 1024) {  // guard against runaway ranges
-                        log(tr("Bypass port range too wide, skipped: %1").arg(tok));
-                        continue;
-                    }
-                    for (int port = lo; port <= hi; ++port) {
-                        exclusions.push_back("*:" + std::to_string(port));
-                        appliedCount++;
-                    }
-                }
-            }
-
+            const std::vector<std::string> exclusions = bypassExclusions(&appliedCount);
+            // Always set, even when empty, so previously applied exclusions don't
+            // persist across reconnects or after the user disables bypass.
+            m_vpnClient->setExtraExclusions(exclusions);
             if (!exclusions.empty()) {
-                m_vpnClient->setExtraExclusions(exclusions);
                 log(tr("Bypass rules applied: %1 rule(s)").arg(appliedCount));
-            } else {
-                // Explicitly clear any previously set exclusions so they don't
-                // persist across reconnects or after the user disables bypass.
-                m_vpnClient->setExtraExclusions({});
             }
 
             // Scan for adapter conflicts if enabled
@@ -1059,6 +1204,9 @@ private:
                 handleScanConflictsBeforeConnect();
             }
 
+            m_vpnClient->setEndpointProbing(m_appSettings.endpoint_probe_enabled, m_appSettings.endpoint_probe_tls);
+            m_vpnClient->setMakeBeforeBreak(m_appSettings.make_before_break);
+
             log(tr("Connecting VPN..."));
             statusBar()->showMessage(tr("Connecting..."), 1500);
             m_vpnClient->connectVpn();
@@ -1119,7 +1267,7 @@ private:
                 m_stateLabel->setText(tr("VPN: Disconnecting"));
                 m_ring->setStatus(ConnectionRing::Disconnecting);
                 updateRingText();
-                m_connectButton->setEnabled(false);
+                m_connectButton->setEnabled(!m_configPath->text().trimmed().isEmpty()); // queued until teardown ends
                 m_disconnectButton->setEnabled(false);
                 m_statsTimer.stop();
                 break;
@@ -1130,6 +1278,9 @@ private:
                 m_connectButton->setEnabled(!m_configPath->text().trimmed().isEmpty());
                 m_disconnectButton->setEnabled(true);
                 m_statsTimer.stop();
+                m_trafficDb.flush();
+                drainConnectionEvents();
+                m_connectionDrainTimer.stop();
                 if (m_appSettings.enable_notifications) {
                     showNotification(tr("VPN Error"), tr("Connection error occurred"));
                 }
@@ -1145,6 +1296,9 @@ private:
                     showNotification(tr("VPN Disconnected"), tr("Successfully disconnected from VPN"));
                 }
                 m_statsTimer.stop();
+                m_trafficDb.flush();
+                drainConnectionEvents();
+                m_connectionDrainTimer.stop();
                 m_trafficGraph->reset();
                 break;
             }
@@ -1173,37 +1327,39 @@ private:
                 m_tray->showMessage(windowTitle(), msg, QSystemTrayIcon::Critical, 4000);
             }
         });
-        connect(m_vpnClient, &QtTrustTunnelClient::connectionInfo, this, [this](const QString &msg) {
-            // Deduplicate: only log each unique "action domain" message once per session.
-            // The core fires this callback for every TCP connection, which can produce
-            // hundreds of identical lines (e.g. "bypass yandex.ru") for a single page load.
-            if (!m_loggedConnectionInfos.contains(msg)) {
-                m_loggedConnectionInfos.insert(msg);
-                log(tr("Connection: %1").arg(msg));
-            }
-        });
+        // Connection info is drained from the client's ring buffer in batches
+        // rather than delivered as one queued event per flow.
+        m_connectionDrainTimer.setInterval(250);
+        connect(&m_connectionDrainTimer, &QTimer::timeout, this, [this]() { drainConnectionEvents(); });
         connect(m_vpnClient, &QtTrustTunnelClient::connectProgress, this, [this](const QString &step) {
             m_stateLabel->setText(tr("VPN: %1").arg(step));
             statusBar()->showMessage(step, 3000);
         });
-        // Accumulate traffic from per-packet output callback (non-TUN-fd platforms)
-        connect(m_vpnClient, &QtTrustTunnelClient::clientOutput, this, [this](const QString &bytes) {
-            bool ok = false;
-            const quint64 b = bytes.toULongLong(&ok);
-            if (ok) {
-                m_bytesRx += b;
+        // Hidden, minimized or occluded: stop the ring animation and widget
+        // repaints, keep counting traffic, and catch up in one frame on show.
+        m_renderScheduler = new RenderScheduler(this);
+        const auto applyRenderActive = [this](bool active) {
+            m_ring->setRenderingPaused(!active);
+            m_trafficGraph->setRenderingPaused(!active);
+            // Nobody is looking: drain connection info less often.
+            m_connectionDrainTimer.setInterval(active ? 250 : 1000);
+            if (active && m_statsTimer.isActive()) {
+                updateTrafficUi();
             }
-        });
-
-        // Accumulate traffic from per-connection tunnel stats (works on all platforms incl. macOS TUN)
-        connect(m_vpnClient, &QtTrustTunnelClient::tunnelStats, this, [this](quint64 upload, quint64 download) {
-            m_bytesRx += download;
-            m_bytesTx += upload;
-        });
-
+        };
+        connect(m_renderScheduler, &RenderScheduler::activeChanged, this, applyRenderActive);
+        applyRenderActive(m_renderScheduler->isActive()); // e.g. started hidden in the tray
         m_statsTimer.setSingleShot(false);
         m_statsTimer.setInterval(1500);
         connect(&m_statsTimer, &QTimer::timeout, this, [this]() {
+            // Pull totals from the client's lock-free counters. Both the
+            // per-packet output callback (non-TUN-fd platforms) and the
+            // per-connection tunnel stats (all platforms incl. macOS TUN)
+            // feed them from core threads without posting Qt events.
+            const TrafficCounters::Snapshot traffic = m_vpnClient->trafficSnapshot();
+            m_bytesRx = traffic.rxBytes;
+            m_bytesTx = traffic.txBytes;
+
             // Feed traffic graph with delta since last sample
             const quint64 rxNow = m_bytesRx;
             const quint64 txNow = m_bytesTx;
@@ -1211,41 +1367,26 @@ private:
             const quint64 txDelta = (txNow >= m_lastGraphTx) ? (txNow - m_lastGraphTx) : txNow;
             m_lastGraphRx = rxNow;
             m_lastGraphTx = txNow;
+            // History is wall-clock bucketed and spans sessions; the live
+            // graph is reset per session.
+            const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+            // Capped, so time spent with the timer stopped (no network) is
+            // not counted as connected.
+            const qint64 spanMs = (m_lastGraphSampleMs > 0 && nowMs > m_lastGraphSampleMs)
+                    ? std::min<qint64>(nowMs - m_lastGraphSampleMs, 2 * m_statsTimer.interval())
+                    : m_statsTimer.interval();
+            m_lastGraphSampleMs = nowMs;
+            m_trafficHistory.addSample(nowMs, rxDelta, txDelta, spanMs);
+            m_trafficDb.record(m_sessionConfigPath, nowMs, rxDelta, txDelta, spanMs);
             m_trafficGraph->addSample(rxDelta, txDelta);
-
-            // Update ring sub-text with live speed
-            if (m_ring && m_ring->status() == ConnectionRing::Connected) {
-                auto formatBytes = [](quint64 bytes) -> QString {
-                    if (bytes < 1024) return QString("%1 B/s").arg(bytes);
-                    if (bytes < 1024 * 1024) return QString("%1 KB/s").arg(bytes / 1024);
-                    return QString("%1 MB/s").arg(bytes / (1024 * 1024));
-                };
-                // deltas are bytes per 1.5s, convert to per-second rate
-                const quint64 rxPerSec = rxDelta * 2 / 3;
-                const quint64 txPerSec = txDelta * 2 / 3;
-                m_ring->setSubText(QString::fromUtf8("\u2193 ") + formatBytes(rxPerSec)
-                        + "  " + QString::fromUtf8("\u2191 ") + formatBytes(txPerSec));
-            }
-
-            if (!m_appSettings.show_traffic_in_status) return;
-            auto fmtTotal = [](quint64 bytes) -> QString {
-                if (bytes < 1024) return QString("%1 B").arg(bytes);
-                if (bytes < 1024 * 1024) return QString("%1 KB").arg(bytes / 1024);
-                if (bytes < 1024ULL * 1024 * 1024) return QString("%1.%2 MB").arg(bytes / (1024 * 1024)).arg((bytes / (1024 * 100)) % 10);
-                return QString("%1.%2 GB").arg(bytes / (1024ULL * 1024 * 1024)).arg((bytes / (1024ULL * 1024 * 100)) % 10);
-            };
-            statusBar()->showMessage(
-                    QString::fromUtf8("\u2193 ") + fmtTotal(m_bytesRx)
-                    + "  " + QString::fromUtf8("\u2191 ") + fmtTotal(m_bytesTx), 1400);
-
-            // Update traffic stats label
+            m_lastRxDelta = rxDelta;
+            m_lastTxDelta = txDelta;
             m_totalSessionRx = m_bytesRx;
             m_totalSessionTx = m_bytesTx;
-            if (m_trafficStatsLabel) {
-                m_trafficStatsLabel->setText(
-                    QString(tr("RX: %1 | TX: %2"))
-                        .arg(fmtTotal(m_totalSessionRx))
-                        .arg(fmtTotal(m_totalSessionTx)));
+
+            // Counters above always run; labels are refreshed once on show.
+            if (m_renderScheduler->isActive()) {
+                updateTrafficUi();
             }
         });
 
@@ -1307,6 +1448,8 @@ private:
             m_toggleLogsAction->setText(m_toggleLogsAction->isChecked() ? (ru ? "Скрыть логи" : "Hide Logs")
                                                                          : (ru ? "Показать логи" : "Show Logs"));
         }
+        if (m_topTalkersAction) m_topTalkersAction->setText(ru ? "Топ направлений" : "Top Talkers");
+        if (m_usageAction) m_usageAction->setText(ru ? "Статистика трафика" : "Traffic Usage");
 
         const QString text = m_stateLabel->text();
         // Order matters: check "Disconnecting" and "Disconnected" BEFORE "Connected",
@@ -1373,54 +1516,105 @@ private:
         statusBar()->showMessage(title + ": " + message, 3000);
     }
 
-    void appendLogChunk(const QByteArray &chunk) {
+    void appendLogChunk(const QByteArray &chunk, LogLineLevel level = LogLineLevel::Info) {
         if (chunk.isEmpty()) {
             return;
         }
-        if (m_appSettings.save_logs && !m_appSettings.log_path.isEmpty()) {
-            // Keep the log file open to avoid exhausting file descriptors
-            // by repeatedly opening/closing on every log line.
-            if (!m_logFile.isOpen() || m_logFile.fileName() != m_appSettings.log_path) {
-                if (m_logFile.isOpen()) m_logFile.close();
-                m_logFile.setFileName(m_appSettings.log_path);
-                QFileInfo info(m_logFile);
-                QDir().mkpath(info.absolutePath());
-                if (!m_logFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
-                    // Failed to open — skip writing this chunk
-                }
-            }
-            if (m_logFile.isOpen()) {
-                m_logFile.write(chunk);
-                m_logFile.flush();
-            }
-        }
-        // Cap the log view to prevent unbounded memory growth.
-        // QTextEdit stores a rich-text document internally; thousands of
-        // appended lines will consume hundreds of megabytes of RAM.
-        static constexpr int MAX_LOG_BLOCKS = 5000;
-        QTextDocument *doc = m_logView->document();
-        if (doc->blockCount() > MAX_LOG_BLOCKS) {
-            QTextCursor trimCursor(doc);
-            trimCursor.movePosition(QTextCursor::Start);
-            // Remove the oldest 20% of lines in one operation
-            const int removeCount = MAX_LOG_BLOCKS / 5;
-            trimCursor.movePosition(QTextCursor::Down, QTextCursor::KeepAnchor, removeCount);
-            trimCursor.removeSelectedText();
-        }
-        m_logView->moveCursor(QTextCursor::End);
-        m_logView->insertPlainText(QString::fromLocal8Bit(chunk));
-        m_logView->ensureCursorVisible();
+        persistLogChunk(chunk);
+        m_logModel->append(level, chunk);
+    }
+
+    void persistLogChunk(const QByteArray &chunk) {
+        m_logSink->append(chunk);
+    }
+
+    // The core logger outlives this window (and m_vpnClient, a child, logs
+    // while it is destroyed), so its callback must stop reaching us first.
+    void detachCoreLogger() {
+        ag::Logger::set_callback([](ag::LogLevel, std::string_view) {});
+    }
+
+    void applyLogFileSettings() {
+        const bool persist = m_appSettings.save_logs && !m_appSettings.log_path.isEmpty();
+        LogWriter::Rotation rotation;
+        rotation.maxBytes = static_cast<qint64>(std::max(0, m_appSettings.log_rotate_mb)) * 1024 * 1024;
+        rotation.maxAgeSecs = std::max(0, m_appSettings.log_rotate_hours) * 3600;
+        rotation.generations = std::max(0, m_appSettings.log_generations);
+        m_logSink->writer.setRotation(rotation);
+        m_logSink->writer.setPath(persist ? m_appSettings.log_path : QString());
+        m_logSink->persist.store(persist, std::memory_order_relaxed);
     }
 
     void log(const QString &line) {
         appendLogChunk(line.toUtf8() + '\n');
     }
 
+    void updateTrafficUi() {
+        // Update ring sub-text with live speed
+        if (m_ring && m_ring->status() == ConnectionRing::Connected) {
+            // deltas are bytes per 1.5s, convert to per-second rate
+            const quint64 rxPerSec = m_lastRxDelta * 2 / 3;
+            const quint64 txPerSec = m_lastTxDelta * 2 / 3;
+            m_ring->setSubText(QString::fromUtf8("\u2193 ") + formatBytes(rxPerSec) + "/s"
+                    + "  " + QString::fromUtf8("\u2191 ") + formatBytes(txPerSec) + "/s");
+        }
+
+        if (!m_appSettings.show_traffic_in_status) return;
+        auto fmtTotal = [](quint64 bytes) -> QString {
+            if (bytes < 1024) return QString("%1 B").arg(bytes);
+            if (bytes < 1024 * 1024) return QString("%1 KB").arg(bytes / 1024);
+            if (bytes < 1024ULL * 1024 * 1024) return QString("%1.%2 MB").arg(bytes / (1024 * 1024)).arg((bytes / (1024 * 100)) % 10);
+            return QString("%1.%2 GB").arg(bytes / (1024ULL * 1024 * 1024)).arg((bytes / (1024ULL * 1024 * 100)) % 10);
+        };
+        statusBar()->showMessage(
+                QString::fromUtf8("\u2193 ") + fmtTotal(m_bytesRx)
+                + "  " + QString::fromUtf8("\u2191 ") + fmtTotal(m_bytesTx), 1400);
+
+        // Update traffic stats label
+        if (m_trafficStatsLabel) {
+            m_trafficStatsLabel->setText(
+                QString(tr("RX: %1 | TX: %2"))
+                    .arg(fmtTotal(m_totalSessionRx))
+                    .arg(fmtTotal(m_totalSessionTx)));
+        }
+    }
+
+    // Consume queued connection_info records in one batch. Deduplicate on
+    // (action, interned domain) so each unique "action domain" pair is logged
+    // once per session: the core reports every TCP/UDP flow, which would
+    // otherwise produce hundreds of identical lines for a single page load.
+    void drainConnectionEvents() {
+        if (!m_vpnClient) return;
+        ConnectionEventQueue &queue = m_vpnClient->connectionEvents();
+        m_connectionBatch.clear();
+        queue.drain(m_connectionBatch);
+        // Connections first, so stats that arrived in the same tick find their flow.
+        for (const ConnectionEvent &ev : m_connectionBatch) {
+            m_flowTable.addConnection(ev);
+        }
+        m_flowStatsBatch.clear();
+        queue.drainStats(m_flowStatsBatch);
+        for (const FlowStatsEvent &ev : m_flowStatsBatch) {
+            m_flowTable.addStats(ev);
+        }
+        for (const ConnectionEvent &ev : m_connectionBatch) {
+            const quint64 key = (static_cast<quint64>(ev.domainId) << 8) | static_cast<quint64>(ev.action);
+            if (m_loggedConnectionKeys.contains(key)) continue;
+            m_loggedConnectionKeys.insert(key);
+            log(tr("Connection: %1 %2").arg(flowActionName(ev.action), queue.domainName(ev.domainId)));
+        }
+        const quint64 dropped = queue.droppedCount();
+        if (dropped != m_reportedConnectionDrops) {
+            log(tr("Connection info: %1 event(s) dropped under load").arg(dropped - m_reportedConnectionDrops));
+            m_reportedConnectionDrops = dropped;
+        }
+    }
+
     // On macOS, QClipboard is unavailable when running as root because the
     // pasteboard is bound to the logged-in user session, not to root.
     // Fall back to piping through pbcopy so the text still reaches the user.
     void copyLogsToClipboard() {
-        const QString text = m_logView->toPlainText();
+        const QString text = m_logModel->toPlainText();
         if (text.isEmpty())
             return;
 #ifdef __APPLE__
@@ -1474,7 +1668,7 @@ private:
 
         const QString lightQss =
             "QMainWindow { background: #F7F8FC; }"
-            "QListWidget, QTextEdit, QLineEdit { background: #FFFFFF; border: 1px solid #DDE0EA; border-radius: 10px; padding: 8px; color: #1E2030; }"
+            "QListWidget, QListView#logView, QTextEdit, QLineEdit { background: #FFFFFF; border: 1px solid #DDE0EA; border-radius: 10px; padding: 8px; color: #1E2030; }"
             "QListWidget::item { padding: 6px 4px; border-radius: 6px; }"
             "QListWidget::item:selected { background: #EEF0FF; color: #4A5ADB; }"
             "QPushButton { background: #EBEDF5; border: 1px solid #D5D8E5; border-radius: 10px; padding: 8px 14px; color: #1E2030; font-weight: 500; }"
@@ -1498,7 +1692,7 @@ private:
 
         const QString darkQss =
             "QMainWindow { background: #101118; }"
-            "QListWidget, QTextEdit, QLineEdit { background: #181922; border: 1px solid #282A38; border-radius: 10px; padding: 8px; color: #E0E2EA; }"
+            "QListWidget, QListView#logView, QTextEdit, QLineEdit { background: #181922; border: 1px solid #282A38; border-radius: 10px; padding: 8px; color: #E0E2EA; }"
             "QListWidget::item { padding: 6px 4px; border-radius: 6px; }"
             "QListWidget::item:selected { background: #252840; color: #8B9CF5; }"
             "QPushButton { background: #20212C; border: 1px solid #30323E; border-radius: 10px; padding: 8px 14px; color: #D0D2DA; font-weight: 500; }"
@@ -1650,38 +1844,16 @@ private:
             m_serverDetailLabel->setText(ru ? "Задайте конфигурацию на вкладке Configs" : "Set a config in the Configs tab");
             return;
         }
-        // Try to extract server info from config TOML
-        QFile f(path);
-        if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            QFileInfo fi(path);
-            m_serverNameLabel->setText(fi.baseName());
-            m_serverDetailLabel->setText(path);
-            return;
-        }
-        const QString content = QString::fromUtf8(f.readAll());
-        f.close();
-
-        // Simple TOML parsing for display
-        QString host, port, proto;
-        for (const QString &line : content.split('\n')) {
-            const QString trimmed = line.trimmed();
-            if (trimmed.startsWith("host") && trimmed.contains('=')) {
-                host = trimmed.section('=', 1).trimmed().remove('"');
-            } else if (trimmed.startsWith("port") && trimmed.contains('=')) {
-                port = trimmed.section('=', 1).trimmed().remove('"');
-            } else if (trimmed.startsWith("proto") && trimmed.contains('=')) {
-                proto = trimmed.section('=', 1).trimmed().remove('"').toUpper();
-            }
-        }
-
-        if (host.isEmpty()) {
+        // Display fields come from the shared parsed-config cache; no file read unless it changed.
+        const std::shared_ptr<const ParsedConfig> parsed = parsedConfig(path);
+        if (parsed->hostname.isEmpty()) {
             QFileInfo fi(path);
             m_serverNameLabel->setText(fi.baseName());
             m_serverDetailLabel->setText(path);
         } else {
-            m_serverNameLabel->setText(host);
-            QString detail = proto.isEmpty() ? "" : proto;
-            if (!port.isEmpty()) detail += (detail.isEmpty() ? "" : ":") + port;
+            m_serverNameLabel->setText(parsed->hostname);
+            QString detail = parsed->protocol;
+            if (!parsed->port.isEmpty()) detail += (detail.isEmpty() ? "" : ":") + parsed->port;
             m_serverDetailLabel->setText(detail.isEmpty() ? path : detail);
         }
     }
@@ -1693,36 +1865,15 @@ private:
             m_configDetailLabel->setText("");
             return;
         }
-        QFile f(path);
-        if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            QFileInfo fi(path);
-            m_configNameLabel->setText(fi.baseName());
-            m_configDetailLabel->setText("");
-            return;
-        }
-        const QString content = QString::fromUtf8(f.readAll());
-        f.close();
-
-        QString host, port, proto;
-        for (const QString &line : content.split('\n')) {
-            const QString trimmed = line.trimmed();
-            if (trimmed.startsWith("host") && trimmed.contains('=')) {
-                host = trimmed.section('=', 1).trimmed().remove('"');
-            } else if (trimmed.startsWith("port") && trimmed.contains('=')) {
-                port = trimmed.section('=', 1).trimmed().remove('"');
-            } else if (trimmed.startsWith("proto") && trimmed.contains('=')) {
-                proto = trimmed.section('=', 1).trimmed().remove('"').toUpper();
-            }
-        }
-
+        const std::shared_ptr<const ParsedConfig> parsed = parsedConfig(path);
         QFileInfo fi(path);
-        if (host.isEmpty()) {
+        if (parsed->hostname.isEmpty()) {
             m_configNameLabel->setText(fi.baseName());
             m_configDetailLabel->setText("");
         } else {
-            m_configNameLabel->setText(host);
-            QString detail = proto.isEmpty() ? "" : proto;
-            if (!port.isEmpty()) detail += (detail.isEmpty() ? "" : ":") + port;
+            m_configNameLabel->setText(parsed->hostname);
+            QString detail = parsed->protocol;
+            if (!parsed->port.isEmpty()) detail += (detail.isEmpty() ? "" : ":") + parsed->port;
             m_configDetailLabel->setText(detail);
         }
     }
@@ -1933,7 +2084,9 @@ private:
     QPushButton *m_connectButton = nullptr;
     QPushButton *m_disconnectButton = nullptr;
     QLabel *m_stateLabel = nullptr;
-    QTextEdit *m_logView = nullptr;
+    QListView *m_logView = nullptr;
+    LogModel *m_logModel = nullptr;
+    bool m_logFollowTail = true;
 
     // — new minimalist UI members —
     ConnectionRing *m_ring = nullptr;
@@ -1948,8 +2101,15 @@ private:
     QLabel *m_trafficStatsLabel = nullptr;
     quint64 m_lastGraphRx = 0;
     quint64 m_lastGraphTx = 0;
+    qint64 m_lastGraphSampleMs = 0; ///< wall clock of the previous stats tick, 0 at session start
+    TrafficHistory m_trafficHistory;
+    TrafficDatabase m_trafficDb;
+    QString m_sessionConfigPath; ///< config of the running session, for per-profile accounting
     quint64 m_totalSessionRx = 0;
     quint64 m_totalSessionTx = 0;
+    quint64 m_lastRxDelta = 0; ///< bytes in the latest stats tick
+    quint64 m_lastTxDelta = 0;
+    RenderScheduler *m_renderScheduler = nullptr;
     QLabel *m_configsPageTitle = nullptr;
     QLabel *m_logsPageTitle = nullptr;
     QPushButton *m_copyLogsBtn = nullptr;
@@ -1967,7 +2127,11 @@ private:
     QAction *m_checkUpdateAction = nullptr;
     QAction *m_quitAction = nullptr;
     QAction *m_toggleLogsAction = nullptr;
+    QAction *m_topTalkersAction = nullptr;
+    QAction *m_usageAction = nullptr;
     UpdateChecker *m_updateChecker = nullptr;
+    RoutingListUpdater *m_routingUpdater = nullptr;
+    bool m_connectAfterRoutingUpdate = false;
     QAction *m_langEnAction = nullptr;
     QAction *m_langRuAction = nullptr;
     QString m_currentLang = "en";
@@ -1976,8 +2140,51 @@ private:
     bool m_isRoot = false;
     quint64 m_bytesRx = 0;
     quint64 m_bytesTx = 0;
-    QSet<QString> m_loggedConnectionInfos;  // dedup connection info logs
-    QFile m_logFile;  // persistent log file handle
+    QSet<quint64> m_loggedConnectionKeys;  // dedup connection info logs: (domainId << 8) | action
+    std::vector<ConnectionEvent> m_connectionBatch;
+    std::vector<FlowStatsEvent> m_flowStatsBatch;
+    FlowTable m_flowTable;
+    QPointer<TopTalkersDialog> m_topTalkersDialog;
+    QPointer<UsageDialog> m_usageDialog;
+    quint64 m_reportedConnectionDrops = 0;
+    QTimer m_connectionDrainTimer;
+    /// Log file, written from its own thread, and the log view. Shared with
+    /// the core logger callback so a core thread never appends to a destroyed
+    /// writer or posts to a destroyed view.
+    struct LogSink {
+        LogWriter writer;
+        std::atomic<bool> persist{false};
+        std::mutex viewMutex;
+        LogModel *view = nullptr; // guarded by viewMutex; cleared before the model is destroyed
+
+        // Any thread: only an enqueue; LogWriter batches the file I/O on its own thread.
+        void append(const QByteArray &chunk) {
+            if (persist.load(std::memory_order_relaxed)) {
+                writer.append(chunk);
+            }
+        }
+
+        // GUI thread.
+        void setView(LogModel *model) {
+            std::lock_guard lock(viewMutex);
+            view = model;
+        }
+
+        // Any thread: queues the line to the view. Posting under the mutex
+        // keeps the view alive until the event is queued; Qt drops it if the
+        // view is destroyed before it runs.
+        void appendToView(LogLineLevel level, const QByteArray &chunk) {
+            std::lock_guard lock(viewMutex);
+            if (!view) {
+                return;
+            }
+            LogModel *model = view;
+            QMetaObject::invokeMethod(model, [model, level, chunk]() {
+                model->append(level, chunk);
+            }, Qt::QueuedConnection);
+        }
+    };
+    std::shared_ptr<LogSink> m_logSink = std::make_shared<LogSink>();
     QTimer m_statsTimer;
     QtTrustTunnelClient *m_vpnClient = nullptr;
     AppSettings m_appSettings;
@@ -2007,6 +2214,7 @@ private:
         if (dlg.resetSettingsRequested()) {
             m_appSettings = AppSettings{}; // defaults
             saveAppSettings(m_appSettings);
+            applyLogFileSettings();
             applyTheme();
             m_vpnClient->setLogLevel(m_appSettings.log_level);
             if (m_toggleLogsAction) m_toggleLogsAction->setChecked(m_appSettings.show_logs_panel);
@@ -2021,17 +2229,25 @@ private:
         if (!newPath.isEmpty()) {
             m_appSettings.log_path = newPath;
         }
+        m_appSettings.log_rotate_mb = dlg.logRotateMb();
+        m_appSettings.log_rotate_hours = dlg.logRotateHours();
+        m_appSettings.log_generations = dlg.logGenerations();
         m_appSettings.theme_mode = dlg.themeMode();
         m_appSettings.auto_connect_on_start = dlg.autoConnectOnStart();
         m_appSettings.notify_on_state = dlg.notifyOnState();
         m_appSettings.notify_only_errors = dlg.notifyOnlyErrors();
         m_appSettings.killswitch_enabled = dlg.killswitchEnabled();
         m_appSettings.strict_certificate_check = dlg.strictCertificateCheck();
+        m_appSettings.endpoint_probe_enabled = dlg.endpointProbeEnabled();
+        m_appSettings.endpoint_probe_tls = dlg.endpointProbeTls();
+        m_appSettings.make_before_break = dlg.makeBeforeBreak();
         m_appSettings.show_logs_panel = dlg.showLogsPanel();
         m_appSettings.show_traffic_in_status = dlg.showTrafficInStatus();
         m_appSettings.show_traffic_graph = dlg.showTrafficGraph();
         m_appSettings.routing_enabled = dlg.routingEnabled();
         m_appSettings.routing_mode = dlg.routingMode();
+        m_appSettings.routing_max_routes = dlg.routingMaxRoutes();
+        m_appSettings.routing_refresh_hours = dlg.routingRefreshHours();
         if (!dlg.routingSourceUrl().isEmpty()) m_appSettings.routing_source_url = dlg.routingSourceUrl();
         if (!dlg.routingCachePath().isEmpty()) m_appSettings.routing_cache_path = dlg.routingCachePath();
         m_appSettings.custom_dns_enabled = dlg.customDnsEnabled();
@@ -2044,7 +2260,11 @@ private:
         m_appSettings.custom_ports_bypass_enabled = dlg.customPortsBypassEnabled();
         m_appSettings.custom_bypass_ports = dlg.customBypassPorts();
         m_vpnClient->setLogLevel(m_appSettings.log_level);
+        m_vpnClient->setMakeBeforeBreak(m_appSettings.make_before_break);
         saveAppSettings(m_appSettings);
+        applyLogFileSettings();
+        applyRoutingRefreshSettings();
+        applyRulesToRunningSession();
         applyTheme();
         if (m_toggleLogsAction) m_toggleLogsAction->setChecked(m_appSettings.show_logs_panel);
         if (m_trafficGraph) m_trafficGraph->setVisible(m_appSettings.show_traffic_graph);
@@ -0,0 +1,54 @@
+#include "RenderScheduler.h"
+
+#include <QEvent>
+#include <QWidget>
+#include <QWindow>
+
+RenderScheduler::RenderScheduler(QWidget *window)
+    : QObject(window)
+    , m_window(window) {
+    m_window->installEventFilter(this);
+    attachHandle();
+    m_active = m_window->isVisible() && !m_window->isMinimized() && (!m_handle || m_handle->isExposed());
+}
+
+void RenderScheduler::attachHandle() {
+    // The native window only exists once the widget has been shown.
+    QWindow *handle = m_window->windowHandle();
+    if (handle == m_handle) {
+        return;
+    }
+    if (m_handle) {
+        m_handle->removeEventFilter(this);
+    }
+    m_handle = handle;
+    if (m_handle) {
+        m_handle->installEventFilter(this);
+    }
+}
+
+bool RenderScheduler::eventFilter(QObject *obj, QEvent *event) {
+    switch (event->type()) {
+    case QEvent::Show:
+    case QEvent::WinIdChange:
+        attachHandle();
+        reevaluate();
+        break;
+    case QEvent::Hide:
+    case QEvent::WindowStateChange:
+    case QEvent::Expose:
+        reevaluate();
+        break;
+    default:
+        break;
+    }
+    return QObject::eventFilter(obj, event);
+}
+
+void RenderScheduler::reevaluate() {
+    const bool active = m_window->isVisible() && !m_window->isMinimized() && (!m_handle || m_handle->isExposed());
+    if (active != m_active) {
+        m_active = active;
+        emit activeChanged(active);
+    }
+}
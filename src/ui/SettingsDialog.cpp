@@ -16,6 +16,7 @@
 #include <QProcess>
 #include <QPushButton>
 #include <QRadioButton>
+#include <QSpinBox>
 #include <QStackedWidget>
 #include <QDesktopServices>
 #include <QFileInfo>
@@ -26,6 +27,7 @@
 
 #include "ConfigInspector.h"
 #include "ConfigStore.h"
+#include "LogWriter.h"
 #include "NetworkAdapterManager.h"
 #include "vpn/trusttunnel/version.h"
 
@@ -115,6 +117,26 @@ SettingsDialog::SettingsDialog(const QString &lang, const AppSettings &settings,
     securityGroupLayout->addWidget(m_strictCertCheck);
     connectionLayout->addWidget(securityGroup);
 
+    auto *endpointGroup = new QGroupBox(ru ? "Выбор сервера" : "Endpoint Selection", connectionPage);
+    auto *endpointGroupLayout = new QVBoxLayout(endpointGroup);
+    m_endpointProbeCheck = new QCheckBox(ru ? "Проверять все адреса и подключаться к самому быстрому"
+                                            : "Probe all addresses and connect to the fastest", endpointGroup);
+    m_endpointProbeCheck->setChecked(settings.endpoint_probe_enabled);
+    m_endpointProbeTlsCheck = new QCheckBox(ru ? "Учитывать TLS-рукопожатие" : "Include TLS handshake in probe",
+                                            endpointGroup);
+    m_endpointProbeTlsCheck->setChecked(settings.endpoint_probe_tls);
+    m_endpointProbeTlsCheck->setEnabled(settings.endpoint_probe_enabled);
+    connect(m_endpointProbeCheck, &QCheckBox::toggled, m_endpointProbeTlsCheck, &QWidget::setEnabled);
+    endpointGroupLayout->addWidget(m_endpointProbeCheck);
+    endpointGroupLayout->addWidget(m_endpointProbeTlsCheck);
+    m_makeBeforeBreakCheck = new QCheckBox(ru ? "Готовить новую сессию до разрыва текущей"
+                                              : "Prepare the new session before dropping the current one", endpointGroup);
+    m_makeBeforeBreakCheck->setToolTip(ru ? "При плановом переподключении сервер проверяется заранее, пока старая сессия работает"
+                                          : "On planned reconnects the endpoint is checked while the old session still carries traffic");
+    m_makeBeforeBreakCheck->setChecked(settings.make_before_break);
+    endpointGroupLayout->addWidget(m_makeBeforeBreakCheck);
+    connectionLayout->addWidget(endpointGroup);
+
     auto *perAppGroup = new QGroupBox(ru ? "Управление приложениями" : "Per-App Control", connectionPage);
     auto *perAppLayout = new QVBoxLayout(perAppGroup);
     m_perAppRulesCheck = new QCheckBox(ru ? "Включить правила для приложений" : "Enable per-app rules", perAppGroup);
@@ -155,6 +177,23 @@ SettingsDialog::SettingsDialog(const QString &lang, const AppSettings &settings,
     routingGroupLayout->addRow(ru ? "Режим:" : "Mode:", modeRow);
     routingGroupLayout->addRow(ru ? "URL списка подсетей:" : "Subnets URL:", m_routingUrlEdit);
     routingGroupLayout->addRow(ru ? "Файл кеша:" : "Cache file:", cacheRow);
+    m_routingMaxRoutesSpin = new QSpinBox(routingGroup);
+    m_routingMaxRoutesSpin->setRange(0, 1000000);
+    m_routingMaxRoutesSpin->setSingleStep(500);
+    m_routingMaxRoutesSpin->setSpecialValueText(ru ? "Без ограничения" : "Unlimited");
+    m_routingMaxRoutesSpin->setValue(settings.routing_max_routes);
+    m_routingMaxRoutesSpin->setToolTip(ru
+            ? "Если маршрутов больше, соседние подсети объединяются в более широкие "
+              "(только в режиме туннеля: маршруты обхода не расширяются)"
+            : "When the list is larger, nearby subnets are merged into wider ones "
+              "(tunnel mode only: bypass routes are never widened)");
+    routingGroupLayout->addRow(ru ? "Макс. маршрутов:" : "Max routes:", m_routingMaxRoutesSpin);
+    m_routingRefreshSpin = new QSpinBox(routingGroup);
+    m_routingRefreshSpin->setRange(0, 168);
+    m_routingRefreshSpin->setSuffix(ru ? " ч" : " h");
+    m_routingRefreshSpin->setSpecialValueText(ru ? "Вручную" : "Manual");
+    m_routingRefreshSpin->setValue(settings.routing_refresh_hours);
+    routingGroupLayout->addRow(ru ? "Обновлять список:" : "Refresh list every:", m_routingRefreshSpin);
     connectionLayout->addWidget(routingGroup);
 
     connectionLayout->addStretch();
@@ -454,6 +493,30 @@ SettingsDialog::SettingsDialog(const QString &lang, const AppSettings &settings,
     logsLayout->addRow(m_saveLogsCheck);
     logsLayout->addRow(ru ? "Уровень логов:" : "Log level:", m_logLevelCombo);
     logsLayout->addRow(ru ? "Файл логов:" : "Log file:", pathRow);
+    m_logRotateMbSpin = new QSpinBox(logsPage);
+    m_logRotateMbSpin->setRange(0, 4096);
+    m_logRotateMbSpin->setSuffix(ru ? " МБ" : " MB");
+    m_logRotateMbSpin->setSpecialValueText(ru ? "Без ограничения" : "Unlimited");
+    m_logRotateMbSpin->setValue(settings.log_rotate_mb);
+    m_logRotateHoursSpin = new QSpinBox(logsPage);
+    m_logRotateHoursSpin->setRange(0, 24 * 30);
+    m_logRotateHoursSpin->setSuffix(ru ? " ч" : " h");
+    m_logRotateHoursSpin->setSpecialValueText(ru ? "Никогда" : "Never");
+    m_logRotateHoursSpin->setValue(settings.log_rotate_hours);
+    m_logGenerationsSpin = new QSpinBox(logsPage);
+    m_logGenerationsSpin->setRange(0, 100);
+    m_logGenerationsSpin->setSpecialValueText(ru ? "Не хранить" : "None");
+    m_logGenerationsSpin->setValue(settings.log_generations);
+    m_logGenerationsSpin->setToolTip(ru
+            ? "Сколько сжатых (gzip) архивов логов хранить"
+            : "How many gzip-compressed log archives to keep");
+    m_logFootprintLabel = new QLabel(logsPage);
+    logsLayout->addRow(ru ? "Ротация по размеру:" : "Rotate at size:", m_logRotateMbSpin);
+    logsLayout->addRow(ru ? "Ротация по возрасту:" : "Rotate after:", m_logRotateHoursSpin);
+    logsLayout->addRow(ru ? "Хранить архивов:" : "Archives to keep:", m_logGenerationsSpin);
+    logsLayout->addRow(ru ? "Занято на диске:" : "Disk usage:", m_logFootprintLabel);
+    connect(m_logPathEdit, &QLineEdit::editingFinished, this, &SettingsDialog::updateLogFootprint);
+    updateLogFootprint();
     logsLayout->addRow(openLogBtn);
     logsLayout->addRow(m_showLogsPanelCheck);
     logsLayout->addRow(m_showTrafficCheck);
@@ -623,6 +686,7 @@ SettingsDialog::SettingsDialog(const QString &lang, const AppSettings &settings,
                 ru ? "Log files (*.log);;All files (*)" : "Log files (*.log);;All files (*)");
         if (!path.isEmpty()) {
             m_logPathEdit->setText(path);
+            updateLogFootprint();
         }
     });
 
@@ -644,6 +708,17 @@ SettingsDialog::SettingsDialog(const QString &lang, const AppSettings &settings,
 bool SettingsDialog::saveLogs() const { return m_saveLogsCheck && m_saveLogsCheck->isChecked(); }
 QString SettingsDialog::logLevel() const { return m_logLevelCombo ? m_logLevelCombo->currentText() : "info"; }
 QString SettingsDialog::logPath() const { return m_logPathEdit ? m_logPathEdit->text().trimmed() : QString(); }
+int SettingsDialog::logRotateMb() const { return m_logRotateMbSpin ? m_logRotateMbSpin->value() : 10; }
+int SettingsDialog::logRotateHours() const { return m_logRotateHoursSpin ? m_logRotateHoursSpin->value() : 24; }
+int SettingsDialog::logGenerations() const { return m_logGenerationsSpin ? m_logGenerationsSpin->value() : 5; }
+
+void SettingsDialog::updateLogFootprint() {
+    // Live file, gzip archives and segments still being compressed.
+    const qint64 bytes = LogWriter::footprint(logPath());
+    m_logFootprintLabel->setText(bytes < 1024 * 1024
+            ? QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1)
+            : QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1));
+}
 QString SettingsDialog::themeMode() const { return m_themeModeCombo ? m_themeModeCombo->currentData().toString() : "system"; }
 bool SettingsDialog::autoConnectOnStart() const { return m_autoConnectCheck && m_autoConnectCheck->isChecked(); }
 bool SettingsDialog::showLogsPanel() const { return m_showLogsPanelCheck && m_showLogsPanelCheck->isChecked(); }
@@ -660,6 +735,11 @@ QString SettingsDialog::routingMode() const {
 }
 QString SettingsDialog::routingSourceUrl() const { return m_routingUrlEdit ? m_routingUrlEdit->text().trimmed() : QString(); }
 QString SettingsDialog::routingCachePath() const { return m_routingCacheEdit ? m_routingCacheEdit->text().trimmed() : QString(); }
+bool SettingsDialog::endpointProbeEnabled() const { return m_endpointProbeCheck && m_endpointProbeCheck->isChecked(); }
+bool SettingsDialog::endpointProbeTls() const { return m_endpointProbeTlsCheck && m_endpointProbeTlsCheck->isChecked(); }
+bool SettingsDialog::makeBeforeBreak() const { return m_makeBeforeBreakCheck && m_makeBeforeBreakCheck->isChecked(); }
+int SettingsDialog::routingMaxRoutes() const { return m_routingMaxRoutesSpin ? m_routingMaxRoutesSpin->value() : 0; }
+int SettingsDialog::routingRefreshHours() const { return m_routingRefreshSpin ? m_routingRefreshSpin->value() : 24; }
 bool SettingsDialog::reinstallTunnelsRequested() const { return m_reinstallTunnels; }
 bool SettingsDialog::flushDnsRequested() const { return m_flushDns; }
 bool SettingsDialog::clearSslCacheRequested() const { return m_clearSslCache; }
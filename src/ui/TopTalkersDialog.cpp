@@ -0,0 +1,237 @@
+#include "TopTalkersDialog.h"
+
+#include <QDialogButtonBox>
+#include <QHash>
+#include <QHeaderView>
+#include <QLabel>
+#include <QTableView>
+#include <QVBoxLayout>
+#include <algorithm>
+
+#include "ConnectionEventQueue.h"
+#include "Format.h"
+
+TopTalkersModel::TopTalkersModel(const QString &lang, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_ru(lang == "ru") {}
+
+void TopTalkersModel::setRows(std::vector<DomainTraffic> rows, const ConnectionEventQueue *names,
+                              quint64 generation) {
+    const auto nameOf = [names](quint32 domainId) {
+        return names ? names->domainName(domainId) : QString::number(domainId);
+    };
+    // Domains only disappear when the flow table is cleared for a new
+    // session, and then nothing in the old view is worth keeping.
+    if (generation != m_generation) {
+        m_generation = generation;
+        beginResetModel();
+        m_rows = std::move(rows);
+        m_names.clear();
+        m_names.reserve(m_rows.size());
+        for (const DomainTraffic &row : m_rows) {
+            m_names.push_back(nameOf(row.domainId));
+        }
+        endResetModel();
+        sortRows();
+        return;
+    }
+
+    // Known domains are updated where they are; names are resolved only for new ones.
+    QHash<quint32, std::size_t> incoming;
+    incoming.reserve(static_cast<qsizetype>(rows.size()));
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        incoming.insert(rows[i].domainId, i);
+    }
+    std::vector<bool> seen(rows.size(), false);
+    int firstChanged = -1;
+    int lastChanged = -1;
+    for (std::size_t i = 0; i < m_rows.size(); ++i) {
+        const std::size_t from = incoming.value(m_rows[i].domainId);
+        seen[from] = true;
+        const DomainTraffic &next = rows[from];
+        DomainTraffic &row = m_rows[i];
+        const bool changed = next.action != row.action || next.flows != row.flows || next.upload != row.upload
+                || next.download != row.download;
+        row = next;
+        if (changed) {
+            firstChanged = firstChanged < 0 ? static_cast<int>(i) : firstChanged;
+            lastChanged = static_cast<int>(i);
+        }
+    }
+    if (firstChanged >= 0) {
+        emit dataChanged(index(firstChanged, ActionCol), index(lastChanged, TotalCol), {Qt::DisplayRole});
+    }
+    std::vector<std::size_t> added;
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        if (!seen[i]) added.push_back(i);
+    }
+    if (!added.empty()) {
+        const int first = static_cast<int>(m_rows.size());
+        beginInsertRows({}, first, first + static_cast<int>(added.size()) - 1);
+        for (std::size_t i : added) {
+            m_rows.push_back(rows[i]);
+            m_names.push_back(nameOf(rows[i].domainId));
+        }
+        endInsertRows();
+    }
+    sortRows();
+}
+
+int TopTalkersModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+int TopTalkersModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant TopTalkersModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(m_rows.size())) return {};
+    const DomainTraffic &row = m_rows[static_cast<std::size_t>(index.row())];
+    if (role == Qt::TextAlignmentRole) {
+        return index.column() >= FlowsCol ? QVariant(Qt::AlignRight | Qt::AlignVCenter)
+                                          : QVariant(Qt::AlignLeft | Qt::AlignVCenter);
+    }
+    if (role != Qt::DisplayRole) return {};
+    switch (index.column()) {
+    case DomainCol: return m_names[static_cast<std::size_t>(index.row())];
+    case ActionCol: return flowActionName(row.action);
+    case FlowsCol: return row.flows;
+    case DownloadCol: return formatBytes(row.download);
+    case UploadCol: return formatBytes(row.upload);
+    case TotalCol: return formatBytes(row.total());
+    default: return {};
+    }
+}
+
+QVariant TopTalkersModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return {};
+    switch (section) {
+    case DomainCol: return m_ru ? "Домен" : "Domain";
+    case ActionCol: return m_ru ? "Действие" : "Action";
+    case FlowsCol: return m_ru ? "Соединения" : "Flows";
+    case DownloadCol: return m_ru ? "Загрузка" : "Download";
+    case UploadCol: return m_ru ? "Отдача" : "Upload";
+    case TotalCol: return m_ru ? "Всего" : "Total";
+    default: return {};
+    }
+}
+
+void TopTalkersModel::sort(int column, Qt::SortOrder order) {
+    m_sortColumn = column;
+    m_sortOrder = order;
+    sortRows();
+}
+
+void TopTalkersModel::sortRows() {
+    // Names are parallel to rows, so sort an index permutation and apply it to both.
+    std::vector<std::size_t> perm(m_rows.size());
+    for (std::size_t i = 0; i < perm.size(); ++i) perm[i] = i;
+    auto keyLess = [this](std::size_t a, std::size_t b) {
+        const DomainTraffic &x = m_rows[a];
+        const DomainTraffic &y = m_rows[b];
+        switch (m_sortColumn) {
+        case DomainCol: return m_names[a] < m_names[b];
+        case ActionCol: return x.action < y.action;
+        case FlowsCol: return x.flows < y.flows;
+        case DownloadCol: return x.download < y.download;
+        case UploadCol: return x.upload < y.upload;
+        default: return x.total() < y.total();
+        }
+    };
+    std::stable_sort(perm.begin(), perm.end(), [&](std::size_t a, std::size_t b) {
+        return m_sortOrder == Qt::AscendingOrder ? keyLess(a, b) : keyLess(b, a);
+    });
+    bool moved = false;
+    for (std::size_t i = 0; i < perm.size() && !moved; ++i) moved = perm[i] != i;
+    if (!moved) return;
+
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+    std::vector<int> newRow(perm.size());
+    for (std::size_t i = 0; i < perm.size(); ++i) newRow[perm[i]] = static_cast<int>(i);
+    const QModelIndexList before = persistentIndexList();
+    QModelIndexList after;
+    after.reserve(before.size());
+    for (const QModelIndex &idx : before) {
+        after.push_back(index(newRow[static_cast<std::size_t>(idx.row())], idx.column()));
+    }
+    std::vector<DomainTraffic> rows;
+    std::vector<QString> names;
+    rows.reserve(perm.size());
+    names.reserve(perm.size());
+    for (std::size_t i : perm) {
+        rows.push_back(m_rows[i]);
+        names.push_back(std::move(m_names[i]));
+    }
+    m_rows = std::move(rows);
+    m_names = std::move(names);
+    changePersistentIndexList(before, after);
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+TopTalkersDialog::TopTalkersDialog(const QString &lang, const FlowTable *table, const ConnectionEventQueue *names,
+                                   QWidget *parent)
+    : QDialog(parent)
+    , m_table(table)
+    , m_names(names)
+    , m_ru(lang == "ru") {
+    setWindowTitle(m_ru ? "Топ направлений" : "Top Talkers");
+    resize(720, 440);
+
+    auto *layout = new QVBoxLayout(this);
+    m_summary = new QLabel(this);
+    layout->addWidget(m_summary);
+
+    m_model = new TopTalkersModel(lang, this);
+    m_view = new QTableView(this);
+    m_view->setModel(m_model);
+    m_view->setSortingEnabled(true);
+    m_view->sortByColumn(TopTalkersModel::TotalCol, Qt::DescendingOrder);
+    m_view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_view->setAlternatingRowColors(true);
+    m_view->setWordWrap(false);
+    // Fixed row height and column widths: the view never measures rows it
+    // does not paint, which keeps thousands of domains cheap to scroll.
+    m_view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_view->verticalHeader()->setDefaultSectionSize(fontMetrics().height() + 6);
+    m_view->verticalHeader()->hide();
+    m_view->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    m_view->horizontalHeader()->setSectionResizeMode(TopTalkersModel::DomainCol, QHeaderView::Stretch);
+    layout->addWidget(m_view, 1);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    m_refreshTimer.setInterval(1000);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &TopTalkersDialog::refresh);
+}
+
+void TopTalkersDialog::refresh() {
+    if (!m_table) return;
+    m_model->setRows(m_table->domainsByTraffic(), m_names, m_table->generation());
+
+    const quint64 unattributed = m_table->unattributedBytes();
+    m_summary->setText(m_ru ? QString("Доменов: %1   Слотов соединений: %2 / %3   Без домена: %4")
+                                      .arg(m_model->rowCount())
+                                      .arg(m_table->flowSlotsUsed())
+                                      .arg(m_table->flowCapacity())
+                                      .arg(formatBytes(unattributed))
+                            : QString("Domains: %1   Flow slots used: %2 / %3   Unattributed: %4")
+                                      .arg(m_model->rowCount())
+                                      .arg(m_table->flowSlotsUsed())
+                                      .arg(m_table->flowCapacity())
+                                      .arg(formatBytes(unattributed)));
+}
+
+void TopTalkersDialog::showEvent(QShowEvent *event) {
+    QDialog::showEvent(event);
+    refresh();
+    m_refreshTimer.start();
+}
+
+void TopTalkersDialog::hideEvent(QHideEvent *event) {
+    m_refreshTimer.stop();
+    QDialog::hideEvent(event);
+}
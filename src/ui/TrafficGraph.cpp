@@ -1,15 +1,37 @@
 #include "TrafficGraph.h"
 
+#include <QDateTime>
+#include <QHelpEvent>
+#include <QMouseEvent>
 #include <QPainter>
-#include <QPainterPath>
+#include <QToolTip>
+#include <QWheelEvent>
 #include <algorithm>
 #include <cmath>
 
+#include "Format.h"
+#include "TrafficHistory.h"
+
 static const QColor kRxColor   {0x34, 0xD3, 0x99};        // emerald green
 static const QColor kTxColor   {0x5B, 0x6E, 0xF5, 0xB0};  // indigo
 static const QColor kRxFill    {0x34, 0xD3, 0x99, 0x28};
 static const QColor kTxFill    {0x5B, 0x6E, 0xF5, 0x18};
 static const QColor kGridColor {0x33, 0x38, 0x44};
+static const QColor kLabelColor{0x8A, 0x90, 0x9C};
+
+static TrafficHistory::Tier tierFor(TrafficGraph::View view) {
+    return static_cast<TrafficHistory::Tier>(static_cast<int>(view) - 1);
+}
+
+/// Fills down to `bottom` under a polyline of `n` points; `pts` must have
+/// two writable slots past the end for the closing corners.
+static void fillUnder(QPainter &p, QPointF *pts, int n, qreal bottom, const QColor &fillColor) {
+    pts[n] = QPointF(pts[n - 1].x(), bottom);
+    pts[n + 1] = QPointF(pts[0].x(), bottom);
+    p.setPen(Qt::NoPen);
+    p.setBrush(fillColor);
+    p.drawPolygon(pts, n + 2);
+}
 
 TrafficGraph::TrafficGraph(QWidget *parent)
     : QWidget(parent)
@@ -17,39 +39,118 @@ TrafficGraph::TrafficGraph(QWidget *parent)
     setMinimumHeight(40);
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     setAttribute(Qt::WA_TranslucentBackground);
+    setCursor(Qt::PointingHandCursor);
+}
+
+void TrafficGraph::setHistory(const TrafficHistory *history) {
+    m_history = history;
+    m_cacheDirty = true;
+    update();
+}
+
+void TrafficGraph::setView(View view) {
+    if (view == m_view) {
+        return;
+    }
+    m_view = view;
+    m_cacheDirty = true;
+    update();
+}
+
+void TrafficGraph::Polyline::push(qreal x, qreal y) {
+    if (count == kMaxSamples) {
+        ++start;
+        --count;
+    }
+    // Keep the two slots after the live window free for the fill corners.
+    if (start + count + 2 >= static_cast<int>(points.size())) {
+        std::copy(points.begin() + start, points.begin() + start + count, points.begin());
+        start = 0;
+    }
+    points[static_cast<size_t>(start + count)] = QPointF(x, y);
+    ++count;
 }
 
 void TrafficGraph::addSample(quint64 rx, quint64 tx) {
-    m_samples.push_back({rx, tx});
-    if (static_cast<int>(m_samples.size()) > kMaxSamples) {
-        m_samples.pop_front();
-    }
-    // Update peak
-    const quint64 localMax = std::max(rx, tx);
-    m_peakValue = std::max(m_peakValue, localMax);
-    // Decay peak slowly so graph scales dynamically
-    if (m_samples.size() > 10) {
-        quint64 maxInWindow = 1;
-        for (const auto &s : m_samples) {
-            maxInWindow = std::max({maxInWindow, s.rx, s.tx});
+    const quint64 seq = m_seq++;
+    m_rxLine.push(static_cast<qreal>(seq), static_cast<qreal>(rx));
+    m_txLine.push(static_cast<qreal>(seq), static_cast<qreal>(tx));
+
+    // Monotonic queue: a sample that is not larger than a newer one can
+    // never be the window max again, so it is dropped from the back. The
+    // entry scrolling out with this sample goes first, so the ring never
+    // holds more than kMaxSamples entries.
+    if (m_peakCount > 0 && m_peaks[m_peakHead].seq + kMaxSamples <= seq) {
+        m_peakHead = (m_peakHead + 1) % kMaxSamples;
+        --m_peakCount;
+    }
+    const quint64 value = std::max(rx, tx);
+    while (m_peakCount > 0 && m_peaks[(m_peakHead + m_peakCount - 1) % kMaxSamples].value <= value) {
+        --m_peakCount;
+    }
+    m_peaks[(m_peakHead + m_peakCount) % kMaxSamples] = {seq, value};
+    ++m_peakCount;
+    m_peakValue = std::max<quint64>(1, m_peaks[m_peakHead].value);
+#ifndef QT_NO_DEBUG
+    // Debug builds cross-check against a scan of the window.
+    quint64 windowMax = 1;
+    for (int i = 0; i < m_rxLine.count; ++i) {
+        windowMax = std::max({windowMax, static_cast<quint64>(m_rxLine.data()[i].y()),
+                static_cast<quint64>(m_txLine.data()[i].y())});
+    }
+    Q_ASSERT(m_peakCount <= kMaxSamples && m_peakValue == windowMax);
+#endif
+
+    // Zoomed out, only a closed bucket changes the picture.
+    if (m_view != View::Live) {
+        const qint64 stamp = historyWindowStart();
+        if (stamp == m_historyStamp) {
+            return;
         }
-        m_peakValue = maxInWindow;
     }
-    update();
+    m_cacheDirty = true;
+    if (!m_paused) {
+        update();
+    }
 }
 
 void TrafficGraph::reset() {
-    m_samples.clear();
+    m_rxLine = {};
+    m_txLine = {};
+    m_peakHead = 0;
+    m_peakCount = 0;
+    m_seq = 0;
     m_peakValue = 1;
-    update();
+    m_cacheDirty = true;
+    if (!m_paused) {
+        update();
+    }
 }
 
-void TrafficGraph::paintEvent(QPaintEvent *) {
-    QPainter p(this);
-    p.setRenderHint(QPainter::Antialiasing, true);
+void TrafficGraph::setRenderingPaused(bool paused) {
+    m_paused = paused;
+    if (!paused && m_cacheDirty) {
+        update();
+    }
+}
 
+void TrafficGraph::resizeEvent(QResizeEvent *event) {
+    m_cacheDirty = true;
+    QWidget::resizeEvent(event);
+}
+
+void TrafficGraph::renderCache() {
+    const qreal dpr = devicePixelRatioF();
     const int w = width();
     const int h = height();
+    if (m_cache.size() != size() * dpr || m_cache.devicePixelRatio() != dpr) {
+        m_cache = QPixmap(size() * dpr);
+        m_cache.setDevicePixelRatio(dpr);
+    }
+    m_cache.fill(Qt::transparent);
+
+    QPainter p(&m_cache);
+    p.setRenderHint(QPainter::Antialiasing, true);
 
     // Grid lines (faint horizontal)
     p.setPen(QPen(kGridColor, 0.5));
@@ -58,51 +159,186 @@ void TrafficGraph::paintEvent(QPaintEvent *) {
         p.drawLine(0, y, w, y);
     }
 
-    if (m_samples.size() < 2) {
+    if (m_view != View::Live) {
+        renderHistory(p);
+        return;
+    }
+
+    const int n = m_rxLine.count;
+    if (n < 2 || h <= 4) {
         return;
     }
 
-    const int n = static_cast<int>(m_samples.size());
+    // Sample space -> pixels: the newest sample sits at the right edge and
+    // the window peak 2 px below the top.
     const qreal xStep = static_cast<qreal>(w) / (kMaxSamples - 1);
-    const qreal xOffset = (kMaxSamples - n) * xStep;
-    const qreal peak = static_cast<qreal>(m_peakValue);
-
-    auto buildPath = [&](auto accessor) -> QPainterPath {
-        QPainterPath path;
-        for (int i = 0; i < n; ++i) {
-            const qreal x = xOffset + i * xStep;
-            const qreal val = static_cast<qreal>(accessor(m_samples[i]));
-            const qreal y = h - (val / peak) * (h - 4) - 2;
-            if (i == 0) {
-                path.moveTo(x, y);
-            } else {
-                path.lineTo(x, y);
-            }
+    const qreal yScale = (h - 4) / static_cast<qreal>(m_peakValue);
+    const qreal firstX = static_cast<qreal>(m_seq) - kMaxSamples;
+    p.setTransform(QTransform(xStep, 0, 0, -yScale, -firstX * xStep, h - 2));
+
+    // Fill under curves, closed at the bottom edge through the spare slots.
+    const qreal bottom = -2 / yScale;
+    fillUnder(p, m_rxLine.points.data() + m_rxLine.start, n, bottom, kRxFill);
+    fillUnder(p, m_txLine.points.data() + m_txLine.start, n, bottom, kTxFill);
+
+    // Draw lines; cosmetic pens keep their width under the scaling transform.
+    QPen txPen(kTxColor, 1.2);
+    txPen.setCosmetic(true);
+    p.setPen(txPen);
+    p.drawPolyline(m_txLine.data(), n);
+    QPen rxPen(kRxColor, 1.5);
+    rxPen.setCosmetic(true);
+    p.setPen(rxPen);
+    p.drawPolyline(m_rxLine.data(), n);
+}
+
+void TrafficGraph::paintEvent(QPaintEvent *) {
+    if (m_cacheDirty || m_cache.size() != size() * devicePixelRatioF()) {
+        renderCache();
+        m_cacheDirty = false;
+    }
+    QPainter p(this);
+    p.drawPixmap(0, 0, m_cache);
+}
+
+qint64 TrafficGraph::historyWindowStart() const {
+    if (m_view == View::Live || !m_history) {
+        return -1;
+    }
+    const TrafficHistory::Tier tier = tierFor(m_view);
+    const std::size_t n = m_history->size(tier);
+    if (n == 0) {
+        return -1;
+    }
+    const qint64 slots = static_cast<qint64>(TrafficHistory::kCapacity[tier]);
+    return m_history->at(tier, n - 1).startMs - (slots - 1) * TrafficHistory::kBucketMs[tier];
+}
+
+void TrafficGraph::renderHistory(QPainter &p) {
+    const int w = width();
+    const int h = height();
+    const TrafficHistory::Tier tier = tierFor(m_view);
+    const qint64 bucketMs = TrafficHistory::kBucketMs[tier];
+    const qint64 windowStart = historyWindowStart();
+    m_historyStamp = windowStart;
+
+    static const char *const kSpans[] = {"10 min", "24 h", "30 d"};
+    QString label = tr("Last %1").arg(QLatin1String(kSpans[tier]));
+
+    const std::size_t total = windowStart < 0 ? 0 : m_history->size(tier);
+    std::size_t first = total;
+    quint64 peak = 1;
+    for (std::size_t i = total; i-- > 0;) {
+        const TrafficHistory::Bucket &b = m_history->at(tier, i);
+        if (b.startMs < windowStart) {
+            break;
         }
-        return path;
-    };
+        first = i;
+        peak = std::max({peak, b.rxBytes, b.txBytes});
+    }
+    if (first < total) {
+        label += QStringLiteral("  ·  ") + tr("peak %1/s").arg(formatBytes(peak * 1000 / bucketMs));
+    }
 
-    auto rxAccessor = [](const Sample &s) { return s.rx; };
-    auto txAccessor = [](const Sample &s) { return s.tx; };
+    p.setPen(kLabelColor);
+    QFont font = p.font();
+    if (font.pointSizeF() > 0) {
+        font.setPointSizeF(font.pointSizeF() * 0.8);
+        p.setFont(font);
+    }
+    p.drawText(QRect(4, 2, w - 8, h - 4), Qt::AlignLeft | Qt::AlignTop, label);
+    if (first == total || h <= 4) {
+        return;
+    }
 
-    QPainterPath rxPath = buildPath(rxAccessor);
-    QPainterPath txPath = buildPath(txAccessor);
+    // Buckets in pixels; a gap (VPN was down) splits the curve into runs.
+    const qreal xStep = static_cast<qreal>(w) / (TrafficHistory::kCapacity[tier] - 1);
+    const qreal yScale = (h - 4) / static_cast<qreal>(peak);
+    std::vector<QPointF> rx;
+    std::vector<QPointF> tx;
+    rx.reserve(total - first + 2);
+    tx.reserve(total - first + 2);
+    auto flushRun = [&]() {
+        const int n = static_cast<int>(rx.size());
+        if (n >= 2) {
+            rx.resize(n + 2);
+            tx.resize(n + 2);
+            fillUnder(p, rx.data(), n, h, kRxFill);
+            fillUnder(p, tx.data(), n, h, kTxFill);
+            p.setPen(QPen(kTxColor, 1.2));
+            p.drawPolyline(tx.data(), n);
+            p.setPen(QPen(kRxColor, 1.5));
+            p.drawPolyline(rx.data(), n);
+        }
+        rx.clear();
+        tx.clear();
+    };
+    qint64 prevStart = 0;
+    for (std::size_t i = first; i < total; ++i) {
+        const TrafficHistory::Bucket &b = m_history->at(tier, i);
+        if (!rx.empty() && b.startMs - prevStart > bucketMs) {
+            flushRun();
+        }
+        const qreal x = static_cast<qreal>(b.startMs - windowStart) / bucketMs * xStep;
+        rx.emplace_back(x, h - 2 - b.rxBytes * yScale);
+        tx.emplace_back(x, h - 2 - b.txBytes * yScale);
+        prevStart = b.startMs;
+    }
+    flushRun();
+}
 
-    // Fill under curves
-    auto fillUnder = [&](QPainterPath linePath, const QColor &fillColor) {
-        QPainterPath fill = linePath;
-        fill.lineTo(xOffset + (n - 1) * xStep, h);
-        fill.lineTo(xOffset, h);
-        fill.closeSubpath();
-        p.fillPath(fill, fillColor);
+bool TrafficGraph::event(QEvent *event) {
+    if (event->type() != QEvent::ToolTip) {
+        return QWidget::event(event);
+    }
+    auto *help = static_cast<QHelpEvent *>(event);
+    if (m_view == View::Live) {
+        QToolTip::showText(help->globalPos(), tr("Click to zoom out to the traffic history"), this);
+        return true;
+    }
+    const TrafficHistory::Tier tier = tierFor(m_view);
+    const qint64 bucketMs = TrafficHistory::kBucketMs[tier];
+    const qint64 windowStart = historyWindowStart();
+    const qreal xStep = static_cast<qreal>(width()) / (TrafficHistory::kCapacity[tier] - 1);
+    const qint64 slot = std::llround(help->pos().x() / xStep);
+    const TrafficHistory::Bucket *b = windowStart < 0 ? nullptr : m_history->find(tier, windowStart + slot * bucketMs);
+    if (!b) {
+        QToolTip::hideText();
+        event->ignore();
+        return true;
+    }
+    static const char *const kFormats[] = {"HH:mm:ss", "HH:mm", "MMM d, HH:mm"};
+    const QString format = QLatin1String(kFormats[tier]);
+    const QString from = QDateTime::fromMSecsSinceEpoch(b->startMs).toString(format);
+    const QString to = QDateTime::fromMSecsSinceEpoch(b->startMs + bucketMs).toString(format);
+    auto line = [&](const char *arrow, quint64 bytes, quint64 p95, quint64 max) {
+        return QString::fromUtf8(arrow) + tr("%1  (avg %2/s, p95 %3/s, peak %4/s)")
+                .arg(formatBytes(bytes), formatBytes(bytes * 1000 / bucketMs), formatBytes(p95), formatBytes(max));
     };
+    QToolTip::showText(help->globalPos(),
+            from + QStringLiteral(" – ") + to + QLatin1Char('\n')
+                    + line("\u2193 ", b->rxBytes, b->rxP95, b->rxMax) + QLatin1Char('\n')
+                    + line("\u2191 ", b->txBytes, b->txP95, b->txMax),
+            this);
+    return true;
+}
 
-    fillUnder(rxPath, kRxFill);
-    fillUnder(txPath, kTxFill);
+void TrafficGraph::mousePressEvent(QMouseEvent *event) {
+    if (event->button() != Qt::LeftButton) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+    // Live -> 10 min -> 24 h -> 30 d -> Live
+    setView(static_cast<View>((static_cast<int>(m_view) + 1) % (static_cast<int>(View::Hours) + 1)));
+}
 
-    // Draw lines
-    p.setPen(QPen(kTxColor, 1.2));
-    p.drawPath(txPath);
-    p.setPen(QPen(kRxColor, 1.5));
-    p.drawPath(rxPath);
+void TrafficGraph::wheelEvent(QWheelEvent *event) {
+    const int step = event->angleDelta().y() < 0 ? 1 : event->angleDelta().y() > 0 ? -1 : 0;
+    const int next = std::clamp(static_cast<int>(m_view) + step, 0, static_cast<int>(View::Hours));
+    if (next == static_cast<int>(m_view)) {
+        event->ignore(); // let an enclosing scroll area have it
+        return;
+    }
+    setView(static_cast<View>(next));
+    event->accept();
 }
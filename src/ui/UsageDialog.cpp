@@ -0,0 +1,202 @@
+#include "UsageDialog.h"
+
+#include <QComboBox>
+#include <QDate>
+#include <QDateTime>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTableView>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <limits>
+
+#include "Format.h"
+
+static QString formatDuration(quint64 secs) {
+    return QString("%1:%2").arg(secs / 3600).arg((secs / 60) % 60, 2, 10, QLatin1Char('0'));
+}
+
+UsageModel::UsageModel(const QString &lang, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_ru(lang == "ru") {}
+
+void UsageModel::setRows(std::vector<TrafficDatabase::UsageRow> rows, std::vector<QString> profileNames,
+                         TrafficDatabase::Granularity granularity) {
+    beginResetModel();
+    m_rows = std::move(rows);
+    m_profileNames = std::move(profileNames);
+    m_granularity = granularity;
+    endResetModel();
+}
+
+int UsageModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+int UsageModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant UsageModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(m_rows.size())) return {};
+    const TrafficDatabase::UsageRow &row = m_rows[static_cast<std::size_t>(index.row())];
+    if (role == Qt::TextAlignmentRole) {
+        return index.column() >= DownloadCol ? QVariant(Qt::AlignRight | Qt::AlignVCenter)
+                                             : QVariant(Qt::AlignLeft | Qt::AlignVCenter);
+    }
+    if (role != Qt::DisplayRole) return {};
+    switch (index.column()) {
+    case PeriodCol:
+        return QDateTime::fromMSecsSinceEpoch(row.periodStartMs)
+                .toString(m_granularity == TrafficDatabase::Granularity::Month ? "yyyy-MM" : "yyyy-MM-dd");
+    case ProfileCol: return m_profileNames[static_cast<std::size_t>(index.row())];
+    case DownloadCol: return formatBytes(row.rxBytes);
+    case UploadCol: return formatBytes(row.txBytes);
+    case TotalCol: return formatBytes(row.rxBytes + row.txBytes);
+    case ConnectedCol: return formatDuration(row.activeSecs);
+    default: return {};
+    }
+}
+
+QVariant UsageModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return {};
+    switch (section) {
+    case PeriodCol: return m_ru ? "Период" : "Period";
+    case ProfileCol: return m_ru ? "Профиль" : "Profile";
+    case DownloadCol: return m_ru ? "Загрузка" : "Download";
+    case UploadCol: return m_ru ? "Отдача" : "Upload";
+    case TotalCol: return m_ru ? "Всего" : "Total";
+    case ConnectedCol: return m_ru ? "Подключено" : "Connected";
+    default: return {};
+    }
+}
+
+UsageDialog::UsageDialog(const QString &lang, const TrafficDatabase *db, QWidget *parent)
+    : QDialog(parent)
+    , m_db(db)
+    , m_ru(lang == "ru") {
+    setWindowTitle(m_ru ? "Статистика трафика" : "Traffic Usage");
+    resize(720, 440);
+
+    auto *layout = new QVBoxLayout(this);
+    auto *filters = new QHBoxLayout();
+    m_profileCombo = new QComboBox(this);
+    m_granularityCombo = new QComboBox(this);
+    m_granularityCombo->addItem(m_ru ? "По дням" : "Daily", static_cast<int>(TrafficDatabase::Granularity::Day));
+    m_granularityCombo->addItem(m_ru ? "По месяцам" : "Monthly", static_cast<int>(TrafficDatabase::Granularity::Month));
+    filters->addWidget(new QLabel(m_ru ? "Профиль:" : "Profile:", this));
+    m_rangeCombo = new QComboBox(this);
+    m_rangeCombo->addItem(m_ru ? "90 дней" : "Last 90 days", Last90Days);
+    m_rangeCombo->addItem(m_ru ? "24 месяца" : "Last 24 months", Last24Months);
+    m_rangeCombo->addItem(m_ru ? "Всё время" : "All time", AllTime);
+    filters->addWidget(m_profileCombo, 1);
+    filters->addWidget(m_granularityCombo);
+    filters->addWidget(m_rangeCombo);
+    layout->addLayout(filters);
+
+    m_summary = new QLabel(this);
+    layout->addWidget(m_summary);
+
+    m_model = new UsageModel(lang, this);
+    m_view = new QTableView(this);
+    m_view->setModel(m_model);
+    m_view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_view->setAlternatingRowColors(true);
+    m_view->setWordWrap(false);
+    m_view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_view->verticalHeader()->setDefaultSectionSize(fontMetrics().height() + 6);
+    m_view->verticalHeader()->hide();
+    m_view->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    m_view->horizontalHeader()->setSectionResizeMode(UsageModel::ProfileCol, QHeaderView::Stretch);
+    layout->addWidget(m_view, 1);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    auto *exportButton = buttons->addButton(m_ru ? "Экспорт CSV..." : "Export CSV...", QDialogButtonBox::ActionRole);
+    connect(exportButton, &QPushButton::clicked, this, &UsageDialog::exportCsv);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    connect(m_profileCombo, &QComboBox::currentIndexChanged, this, &UsageDialog::refresh);
+    connect(m_granularityCombo, &QComboBox::currentIndexChanged, this, &UsageDialog::refresh);
+    connect(m_rangeCombo, &QComboBox::currentIndexChanged, this, &UsageDialog::refresh);
+}
+
+TrafficDatabase::Granularity UsageDialog::granularity() const {
+    return static_cast<TrafficDatabase::Granularity>(m_granularityCombo->currentData().toInt());
+}
+
+quint32 UsageDialog::profileId() const {
+    return m_profileCombo->currentData().toUInt(); // 0 = all profiles
+}
+
+qint64 UsageDialog::rangeStartMs() const {
+    // Whole days / months, so the first row is not a partial period.
+    const QDate today = QDate::currentDate();
+    switch (m_rangeCombo->currentData().toInt()) {
+    case Last90Days: return today.addDays(-89).startOfDay().toMSecsSinceEpoch();
+    case Last24Months:
+        return QDate(today.year(), today.month(), 1).addMonths(-23).startOfDay().toMSecsSinceEpoch();
+    default: return 0;
+    }
+}
+
+void UsageDialog::refresh() {
+    if (!m_db) return;
+
+    // Profiles appear as they are first used; keep the current choice.
+    const quint32 selected = profileId();
+    const std::vector<TrafficDatabase::Profile> profiles = m_db->profiles();
+    if (m_profileCombo->count() != static_cast<int>(profiles.size()) + 1) {
+        const QSignalBlocker blocker(m_profileCombo);
+        m_profileCombo->clear();
+        m_profileCombo->addItem(m_ru ? "Все профили" : "All profiles", 0u);
+        for (const TrafficDatabase::Profile &p : profiles) {
+            m_profileCombo->addItem(p.name(), p.id);
+            m_profileCombo->setItemData(m_profileCombo->count() - 1, p.path, Qt::ToolTipRole);
+        }
+        m_profileCombo->setCurrentIndex(std::max(0, m_profileCombo->findData(selected)));
+    }
+
+    std::vector<TrafficDatabase::UsageRow> rows =
+            m_db->usage(granularity(), rangeStartMs(), std::numeric_limits<qint64>::max(), profileId());
+    std::reverse(rows.begin(), rows.end());
+    std::vector<QString> names;
+    names.reserve(rows.size());
+    quint64 rx = 0;
+    quint64 tx = 0;
+    for (const TrafficDatabase::UsageRow &row : rows) {
+        names.push_back(m_db->profileName(row.profileId));
+        rx += row.rxBytes;
+        tx += row.txBytes;
+    }
+    m_model->setRows(std::move(rows), std::move(names), granularity());
+    m_summary->setText(m_ru ? QString("Всего: ↓ %1  ↑ %2").arg(formatBytes(rx), formatBytes(tx))
+                            : QString("Total: ↓ %1  ↑ %2").arg(formatBytes(rx), formatBytes(tx)));
+}
+
+void UsageDialog::exportCsv() {
+    if (!m_db) return;
+    const QString path = QFileDialog::getSaveFileName(
+            this,
+            m_ru ? "Экспорт статистики" : "Export usage",
+            "traffic-usage.csv",
+            "CSV files (*.csv);;All files (*)");
+    if (path.isEmpty()) return;
+    QString error;
+    if (!m_db->exportCsv(path, granularity(), rangeStartMs(), std::numeric_limits<qint64>::max(), profileId(),
+                         &error)) {
+        QMessageBox::warning(this, m_ru ? "Экспорт статистики" : "Export usage",
+                             (m_ru ? "Не удалось записать файл: " : "Cannot write file: ") + error);
+    }
+}
+
+void UsageDialog::showEvent(QShowEvent *event) {
+    QDialog::showEvent(event);
+    refresh();
+}
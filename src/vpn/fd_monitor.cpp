@@ -0,0 +1,247 @@
+#include "fd_monitor.h"
+
+#include <QStringList>
+#include <algorithm>
+#include <chrono>
+#include <unordered_set>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <dirent.h>
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#elif defined(__APPLE__)
+#include <libproc.h>
+#include <sys/proc_info.h>
+#endif
+
+static constexpr double kGrowthAlpha = 0.3;
+static constexpr double kMinGrowthPerMin = 0.5; // below this the trend is noise
+
+static qint64 steadyMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if defined(__linux__) || defined(__APPLE__)
+static int countDirEntries(const char *path) {
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return -1;
+    }
+    int count = 0;
+    while (const dirent *e = readdir(dir)) {
+        if (e->d_name[0] != '.') {
+            ++count;
+        }
+    }
+    closedir(dir);
+    return count;
+}
+#endif
+
+#if defined(__APPLE__)
+static std::vector<proc_fdinfo> listFds() {
+    const pid_t pid = getpid();
+    const int bytes = proc_pidinfo(pid, PROC_PIDLISTFDS, 0, nullptr, 0);
+    if (bytes <= 0) {
+        return {};
+    }
+    // Headroom for fds opened between the two calls.
+    std::vector<proc_fdinfo> fds(static_cast<size_t>(bytes) / PROC_PIDLISTFD_SIZE + 32);
+    const int got = proc_pidinfo(pid, PROC_PIDLISTFDS, 0, fds.data(),
+            static_cast<int>(fds.size() * PROC_PIDLISTFD_SIZE));
+    fds.resize(got > 0 ? static_cast<size_t>(got) / PROC_PIDLISTFD_SIZE : 0);
+    return fds;
+}
+#endif
+
+int FdMonitor::openFdCount() {
+#if defined(__linux__)
+    struct stat st{};
+    if (stat("/proc/self/fd", &st) == 0 && st.st_size > 0) {
+        return static_cast<int>(st.st_size);
+    }
+    return countDirEntries("/proc/self/fd");
+#elif defined(__APPLE__)
+    const std::vector<proc_fdinfo> fds = listFds();
+    return fds.empty() ? countDirEntries("/dev/fd") : static_cast<int>(fds.size());
+#else
+    return -1; // not supported on Windows
+#endif
+}
+
+int FdMonitor::fdLimit() {
+#ifndef _WIN32
+    struct rlimit rl{};
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+        return rl.rlim_cur == RLIM_INFINITY ? -1 : static_cast<int>(std::min<rlim_t>(rl.rlim_cur, 1 << 30));
+    }
+#endif
+    return -1;
+}
+
+FdMonitor::Sample FdMonitor::sample() {
+    Sample s;
+    s.open = openFdCount();
+    s.limit = fdLimit();
+    const qint64 now = steadyMs();
+    if (s.open >= 0 && m_lastOpen >= 0 && now > m_lastSampleMs) {
+        const double perMin = (s.open - m_lastOpen) * 60000.0 / static_cast<double>(now - m_lastSampleMs);
+        m_growthPerMin = kGrowthAlpha * perMin + (1 - kGrowthAlpha) * m_growthPerMin;
+        m_growingSamples = m_growthPerMin >= kMinGrowthPerMin ? m_growingSamples + 1 : 0;
+    }
+    m_lastOpen = s.open;
+    m_lastSampleMs = now;
+    s.growthPerMin = m_growthPerMin;
+    s.growingSamples = m_growingSamples;
+    if (s.limit > 0 && s.open >= 0 && m_growthPerMin >= kMinGrowthPerMin) {
+        s.secsToExhaustion = std::max(0, s.limit - s.open) * 60.0 / m_growthPerMin;
+    }
+    return s;
+}
+
+void FdMonitor::resetTrend() {
+    m_lastOpen = -1;
+    m_growthPerMin = 0;
+    m_growingSamples = 0;
+}
+
+#if defined(__linux__)
+/// Socket inodes listed in a /proc/net table; `inodeColumn` is 0-based.
+static void collectInodes(const char *path, int inodeColumn, std::unordered_set<quint64> &out) {
+    FILE *f = std::fopen(path, "r");
+    if (!f) {
+        return;
+    }
+    char line[512];
+    bool header = true;
+    while (std::fgets(line, sizeof(line), f)) {
+        if (header) {
+            header = false;
+            continue;
+        }
+        int column = 0;
+        for (char *tok = std::strtok(line, " \t\n"); tok; tok = std::strtok(nullptr, " \t\n"), ++column) {
+            if (column == inodeColumn) {
+                out.insert(std::strtoull(tok, nullptr, 10));
+                break;
+            }
+        }
+    }
+    std::fclose(f);
+}
+#endif
+
+FdMonitor::Breakdown FdMonitor::classify() const {
+    Breakdown b;
+#if defined(__linux__)
+    DIR *dir = opendir("/proc/self/fd");
+    if (!dir) {
+        return b;
+    }
+    std::vector<quint64> socketInodes;
+    char target[512];
+    const int ownFd = dirfd(dir);
+    while (const dirent *e = readdir(dir)) {
+        if (e->d_name[0] == '.' || std::atoi(e->d_name) == ownFd) {
+            continue;
+        }
+        const ssize_t n = readlinkat(dirfd(dir), e->d_name, target, sizeof(target) - 1);
+        if (n < 0) {
+            continue; // closed since readdir() saw it
+        }
+        target[n] = '\0';
+        ++b.total;
+        if (std::strncmp(target, "socket:[", 8) == 0) {
+            socketInodes.push_back(std::strtoull(target + 8, nullptr, 10));
+        } else if (std::strncmp(target, "pipe:", 5) == 0) {
+            ++b.pipes;
+        } else if (std::strcmp(target, "anon_inode:[eventfd]") == 0) {
+            ++b.eventfds;
+        } else if (std::strcmp(target, "anon_inode:[eventpoll]") == 0) {
+            ++b.epoll;
+        } else if (std::strcmp(target, "anon_inode:[timerfd]") == 0) {
+            ++b.timerfds;
+        } else if (std::strcmp(target, "/dev/net/tun") == 0) {
+            ++b.tun;
+        } else if (target[0] == '/') {
+            ++b.files;
+        } else {
+            ++b.other;
+        }
+    }
+    closedir(dir);
+
+    if (!socketInodes.empty()) {
+        std::unordered_set<quint64> tcp;
+        std::unordered_set<quint64> udp;
+        std::unordered_set<quint64> unixSockets;
+        collectInodes("/proc/self/net/tcp", 9, tcp);
+        collectInodes("/proc/self/net/tcp6", 9, tcp);
+        collectInodes("/proc/self/net/udp", 9, udp);
+        collectInodes("/proc/self/net/udp6", 9, udp);
+        collectInodes("/proc/self/net/unix", 6, unixSockets);
+        for (const quint64 inode : socketInodes) {
+            if (tcp.count(inode)) {
+                ++b.tcp;
+            } else if (udp.count(inode)) {
+                ++b.udp;
+            } else if (unixSockets.count(inode)) {
+                ++b.unixSockets;
+            } else {
+                ++b.otherSockets; // netlink, raw, ...
+            }
+        }
+    }
+#elif defined(__APPLE__)
+    const pid_t pid = getpid();
+    for (const proc_fdinfo &fd : listFds()) {
+        ++b.total;
+        switch (fd.proc_fdtype) {
+        case PROX_FDTYPE_SOCKET: {
+            socket_fdinfo si{};
+            if (proc_pidfdinfo(pid, fd.proc_fd, PROC_PIDFDSOCKETINFO, &si, sizeof(si)) != sizeof(si)) {
+                ++b.otherSockets;
+                break;
+            }
+            switch (si.psi.soi_kind) {
+            case SOCKINFO_TCP: ++b.tcp; break;
+            case SOCKINFO_IN: ++b.udp; break;
+            case SOCKINFO_UN: ++b.unixSockets; break;
+            case SOCKINFO_KERN_CTL: ++b.tun; break; // utun
+            default: ++b.otherSockets; break;
+            }
+            break;
+        }
+        case PROX_FDTYPE_PIPE: ++b.pipes; break;
+        case PROX_FDTYPE_KQUEUE: ++b.epoll; break;
+        case PROX_FDTYPE_VNODE: ++b.files; break;
+        default: ++b.other; break;
+        }
+    }
+#endif
+    return b;
+}
+
+QString FdMonitor::Breakdown::toString() const {
+    const std::pair<const char *, int> parts[] = {
+        {"tcp", tcp}, {"udp", udp}, {"unix", unixSockets}, {"socket", otherSockets},
+        {"pipe", pipes}, {"eventfd", eventfds}, {"poll", epoll}, {"timerfd", timerfds},
+        {"tun", tun}, {"file", files}, {"other", other},
+    };
+    QStringList out;
+    for (const auto &[name, count] : parts) {
+        if (count > 0) {
+            out << QStringLiteral("%1 %2").arg(QLatin1String(name)).arg(count);
+        }
+    }
+    return out.join(QStringLiteral(", "));
+}
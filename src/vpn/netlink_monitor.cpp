@@ -0,0 +1,178 @@
+#include "netlink_monitor.h"
+
+#include <QFile>
+#include <QSocketNotifier>
+#include <QStringList>
+#include <algorithm>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/route.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+static constexpr int kQuietPeriodMs = 400;  // links and routes usually settle within this
+static constexpr int kMaxDebounceMs = 2000; // re-evaluate at least this often while flapping
+static constexpr int kRecvBufferBytes = 1 << 20; // a docker/VPN start-up burst overflows the default
+
+#ifdef __linux__
+// TUN/TAP devices (our own tunnel included) never count as "the network".
+static bool isTunDevice(const QByteArray &iface) {
+    return QFile::exists(QStringLiteral("/sys/class/net/%1/tun_flags").arg(QString::fromLatin1(iface)));
+}
+#endif
+
+NetlinkMonitor::NetlinkMonitor(QObject *parent)
+    : QObject(parent) {
+    m_debounce.setSingleShot(true);
+    connect(&m_debounce, &QTimer::timeout, this, &NetlinkMonitor::evaluate);
+}
+
+NetlinkMonitor::~NetlinkMonitor() {
+    stop();
+}
+
+bool NetlinkMonitor::start() {
+#ifdef __linux__
+    if (m_fd >= 0) {
+        return true;
+    }
+    m_fd = ::socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (m_fd < 0) {
+        return false;
+    }
+    // Best effort: the kernel caps it at net.core.rmem_max, and an overflow
+    // is still handled in onReadable().
+    const int rcvbuf = kRecvBufferBytes;
+    ::setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    sockaddr_nl addr{};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR | RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE;
+    if (::bind(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    m_route = currentDefaultRoute();
+    m_available = !m_route.isEmpty();
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &NetlinkMonitor::onReadable);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void NetlinkMonitor::stop() {
+    m_debounce.stop();
+    delete m_notifier;
+    m_notifier = nullptr;
+#ifdef __linux__
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+#endif
+    m_fd = -1;
+}
+
+void NetlinkMonitor::onReadable() {
+#ifdef __linux__
+    // Drain everything queued; the payload only tells us *that* something
+    // changed, the routing table is re-read once the burst is over.
+    alignas(nlmsghdr) char buf[8192];
+    bool relevant = false;
+    for (;;) {
+        const ssize_t n = ::recv(m_fd, buf, sizeof(buf), 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == ENOBUFS) {
+                // The socket overflowed and some notifications were lost, so
+                // whatever they said has to be assumed; keep draining.
+                relevant = true;
+                continue;
+            }
+            break; // EAGAIN/EWOULDBLOCK: drained; other errors won't clear by retrying
+        }
+        if (n == 0) {
+            break;
+        }
+        int len = static_cast<int>(n);
+        for (auto *h = reinterpret_cast<nlmsghdr *>(buf); NLMSG_OK(h, len); h = NLMSG_NEXT(h, len)) {
+            switch (h->nlmsg_type) {
+            case RTM_NEWLINK:
+            case RTM_DELLINK:
+            case RTM_NEWADDR:
+            case RTM_DELADDR:
+            case RTM_NEWROUTE:
+            case RTM_DELROUTE:
+                relevant = true;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    if (!relevant) {
+        return;
+    }
+    if (!m_debounce.isActive()) {
+        m_firstPending.start();
+    }
+    const qint64 waited = m_firstPending.elapsed();
+    m_debounce.start(static_cast<int>(std::max<qint64>(0, std::min<qint64>(kQuietPeriodMs, kMaxDebounceMs - waited))));
+#endif
+}
+
+void NetlinkMonitor::evaluate() {
+    const QString route = currentDefaultRoute();
+    const bool available = !route.isEmpty();
+    if (available == m_available && route == m_route) {
+        return;
+    }
+    m_available = available;
+    m_route = route;
+    emit defaultRouteChanged(available);
+}
+
+QString NetlinkMonitor::currentDefaultRoute() {
+#ifdef __linux__
+    // IPv4: Iface Destination Gateway Flags RefCnt Use Metric Mask ...
+    // procfs reports a size of 0, so read it whole rather than relying on atEnd().
+    QFile v4("/proc/net/route");
+    if (v4.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> lines = v4.readAll().split('\n');
+        for (qsizetype i = 1; i < lines.size(); ++i) { // line 0 is the header
+            const QList<QByteArray> f = lines[i].simplified().split(' ');
+            if (f.size() < 8) {
+                continue;
+            }
+            const uint flags = f[3].toUInt(nullptr, 16);
+            if (f[1] == "00000000" && f[7] == "00000000" && (flags & RTF_UP) && !(flags & RTF_REJECT)
+                    && !isTunDevice(f[0])) {
+                return QString::fromLatin1(f[0] + ' ' + f[2]);
+            }
+        }
+    }
+    // IPv6: dest plen src splen nexthop metric refcnt use flags iface
+    QFile v6("/proc/net/ipv6_route");
+    if (v6.open(QIODevice::ReadOnly)) {
+        for (const QByteArray &line : v6.readAll().split('\n')) {
+            const QList<QByteArray> f = line.simplified().split(' ');
+            if (f.size() < 10) {
+                continue;
+            }
+            const uint flags = f[8].toUInt(nullptr, 16);
+            if (f[1] == "00" && f[0] == QByteArray(32, '0') && (flags & RTF_UP) && !(flags & RTF_REJECT)
+                    && f[9] != "lo" && !isTunDevice(f[9])) {
+                return QString::fromLatin1(f[9] + ' ' + f[4]);
+            }
+        }
+    }
+#endif
+    return {};
+}
@@ -1,12 +1,13 @@
 #include "qt_trusttunnel_client.h"
 #include <QApplication>
 #include <QMetaObject>
-#include <QRandomGenerator>
-#include <QThread>
 #include <algorithm>
 #include <chrono>
 #include <toml++/toml.h>
 
+#include "ConfigCache.h"
+#include "EndpointProber.h"
+
 #ifdef _WIN32
 // Windows SDK doesn't define POSIX iovec; define a minimal version before vpn.h uses it.
 #ifndef IOVEC_DEFINED_QT
@@ -55,6 +56,28 @@ static ag::LogLevel parse_log_level(const QString &level) {
     return ag::LOG_LEVEL_INFO;
 }
 
+static constexpr int kRouteBackGraceMs = 1500;    // core's chance to self-recover once the route returns
+static constexpr int kRouteStillUpGraceMs = 5000; // same, when the route was never lost
+
+static constexpr int kFdMinGrowingSamples = 3;          // fd watchdog: trend must hold for ~30 s
+static constexpr double kFdExhaustionHorizonSecs = 600; // reconnect early if the limit is this close
+static constexpr qint64 kFdClassifyIntervalMs = 60000;
+
+// Reconnect handling for the error code the core ends a session with. Codes
+// that say nothing about the endpoint get the default backoff.
+static FailureKind failureKindFor(int coreErrorCode) {
+    switch (coreErrorCode) {
+    case ag::VPN_EC_AUTH_REQUIRED: return FailureKind::Auth;
+    case ag::VPN_EC_LOCATION_UNAVAILABLE: return FailureKind::Timeout;
+    default: return FailureKind::Other;
+    }
+}
+
+static int64_t steadyNowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 QtTrustTunnelClient::QtTrustTunnelClient(QObject *parent)
     : QObject(parent) {
     m_reconnectTimer.setSingleShot(true);
@@ -63,55 +86,119 @@ QtTrustTunnelClient::QtTrustTunnelClient(QObject *parent)
     // Periodically check open fd count and force clean reconnect if leaking.
     m_fdWatchdogTimer.setInterval(10000); // every 10 seconds
     connect(&m_fdWatchdogTimer, &QTimer::timeout, this, &QtTrustTunnelClient::checkFdHealth);
+    m_fdClassifier.setMaxThreadCount(1);
 
-    // If we stay stuck in WaitingForNetwork for more than 30 s (common after
-    // sleep/wake or a brief network blip where the core doesn't self-recover),
-    // force a clean teardown and reconnect from the Qt side.
+    // If we stay stuck in WaitingForNetwork for more than 30 s (a network blip
+    // the core doesn't self-recover from), force a clean teardown and
+    // reconnect from the Qt side. This is the last resort: netlink and the
+    // suspend monitor below normally react much sooner.
     m_networkWaitTimer.setSingleShot(true);
     m_networkWaitTimer.setInterval(30000);
     connect(&m_networkWaitTimer, &QTimer::timeout, this, [this]() {
         if (m_state == State::WaitingForNetwork && !m_stopRequested && m_autoReconnect) {
-            teardownClient();
-            scheduleReconnect(QStringLiteral("network wait timeout: forcing clean reconnect"));
+            // Local connectivity problem, not the endpoint's.
+            recordEndpointOutcome(QStringLiteral("network wait timeout"), false);
+            teardownClientAsync([this]() {
+                if (!m_stopRequested) {
+                    scheduleReconnect(QStringLiteral("network wait timeout: forcing clean reconnect"),
+                            FailureKind::Network);
+                }
+            });
+        }
+    });
+
+    // On Linux, rtnetlink tells us the moment a usable default route is back
+    // (link up, wifi roam, DHCP lease), so recovery follows the network
+    // instead of the fixed timeout above. The core gets a short grace period
+    // to recover on its own; after that we reconnect immediately, without
+    // backoff, since the outage was local.
+    m_routeBackTimer.setSingleShot(true);
+    connect(&m_routeBackTimer, &QTimer::timeout, this, [this]() {
+        if (m_state != State::WaitingForNetwork || m_stopRequested || !m_autoReconnect) {
+            return;
         }
+        m_networkWaitTimer.stop();
+        recordEndpointOutcome(QStringLiteral("network changed"), false);
+        emit connectProgress(tr("Network is back, reconnecting..."));
+        teardownClientAsync([this]() {
+            if (!m_stopRequested) {
+                setState(State::Reconnecting);
+                doConnectAttemptInThread();
+            }
+        });
     });
+    connect(&m_netlinkMonitor, &NetlinkMonitor::defaultRouteChanged, this, [this](bool available) {
+        if (!available) {
+            m_routeBackTimer.stop(); // flapped away again before the grace period ended
+        } else if (m_state == State::WaitingForNetwork) {
+            m_routeBackTimer.start(kRouteBackGraceMs);
+        }
+    });
+    m_netlinkMonitor.start();
+
+    // After sleep/wake the core's sockets are dead but it often doesn't
+    // notice for a long time. Don't wait for it: tear the session down and
+    // start a fresh one, which re-probes the endpoints first. If the network
+    // isn't back yet (wifi still associating) and netlink is available, wait
+    // for the route instead of burning attempts into backoff.
+    connect(&m_suspendMonitor, &SuspendMonitor::resumed, this, [this](qint64 sleptMs) {
+        if (m_stopRequested || !m_autoReconnect || m_state == State::Disconnected || m_state == State::Error
+                || m_state == State::Disconnecting) {
+            return;
+        }
+        m_reconnectTimer.stop();
+        m_networkWaitTimer.stop();
+        m_routeBackTimer.stop();
+        m_reconnectPolicy.resetBackoff(); // backoff from before the suspend is meaningless now
+        recordEndpointOutcome(QStringLiteral("resumed from sleep"), false);
+        emit connectProgress(tr("Resumed after %1 s asleep, reconnecting...").arg(sleptMs / 1000));
+        teardownClientAsync([this]() {
+            if (m_stopRequested) {
+                return;
+            }
+            if (m_netlinkMonitor.isActive() && !m_netlinkMonitor.defaultRouteAvailable()) {
+                setState(State::WaitingForNetwork);
+                m_networkWaitTimer.start();
+                return;
+            }
+            setState(State::Reconnecting);
+            doConnectAttemptInThread();
+        });
+    });
+    m_suspendMonitor.start();
 }
 
 QtTrustTunnelClient::~QtTrustTunnelClient() {
-    // Suppress all signal emission during destruction — connected slots may
-    // reference this object which is already being torn down.
+    shutdown();
+}
+
+void QtTrustTunnelClient::shutdown() {
+    if (m_shutDown) {
+        return;
+    }
+    m_shutDown = true;
+    // Suppress all signal emission from here on — connected slots may
+    // reference objects that are already being torn down.
     m_stopRequested = true;
     m_reconnectTimer.stop();
-    if (m_connectThread.isRunning()) {
-        m_connectThread.quit();
-        m_connectThread.wait();
-    }
+    m_fdWatchdogTimer.stop();
+    m_networkWaitTimer.stop();
+    m_routeBackTimer.stop();
     blockSignals(true);
+    // The remaining teardown is finished synchronously: the process is going
+    // away and the system DNS / routes must be restored before it does. A
+    // queued asynchronous teardown is dropped; a running one is waited for.
+    m_executor.shutdown();
+    m_fdClassifier.waitForDone(); // its result is queued to this object
     teardownClient();
+    m_endpointHealth.flush(); // the client is never destroyed at quit
 }
 
 void QtTrustTunnelClient::teardownClient() {
-    // If teardownClient is called from the main thread (e.g. handleCoreStateChanged,
-    // checkFdHealth, disconnectVpn) we MUST wait for m_connectThread to finish before
-    // touching m_client.  The thread may currently be inside m_client->connect() or
-    // m_client->set_system_dns(), so resetting m_client while it runs is a data race.
-    //
-    // When teardownClient is called FROM the connect thread itself (doConnectAttempt
-    // on a reconnect) we must NOT join it — that would deadlock.
-    if (QThread::currentThread() != &m_connectThread && m_connectThread.isRunning()) {
-        m_connectThread.quit();
-        // BUG FIX: wait() without a timeout — a finite wait(5000) returns false
-        // after 5 s even when the thread is still alive inside a blocking native
-        // call (m_client->connect, set_system_dns).  Calling m_client.reset()
-        // while the thread holds a reference is a use-after-free / data race.
-        // As a last resort after 15 s we terminate to prevent a complete hang.
-        if (!m_connectThread.wait(15000)) {
-            qWarning("[teardownClient] connect thread did not exit in 15 s — forcing terminate");
-            m_connectThread.terminate();
-            m_connectThread.wait();
-        }
-    }
-
+    // Only called where nothing else can be using the client: on the executor
+    // thread (doConnectAttempt on a reconnect, or a Teardown command) or from
+    // the destructor after shutting the executor down. The GUI thread goes
+    // through teardownClientAsync().
     if (m_networkMonitor) {
         m_networkMonitor->stop();
         m_networkMonitor.reset();
@@ -122,16 +209,45 @@ void QtTrustTunnelClient::teardownClient() {
     m_client.reset();
 }
 
+void QtTrustTunnelClient::teardownClientAsync(std::function<void()> then) {
+    if (then) {
+        m_afterTeardown.push_back(std::move(then));
+    }
+    if (m_teardownPending) {
+        return; // already queued; `then` runs when it completes
+    }
+    // m_client->disconnect() can take seconds, and a connect attempt may be
+    // stuck inside m_client->connect() or set_system_dns(). The executor runs
+    // this after that attempt returns, off the GUI thread, so nothing ever
+    // joins or terminates a thread here.
+    m_teardownPending = true;
+    m_executor.post(VpnCommandExecutor::Command::Teardown, [this]() {
+        teardownClient();
+        QMetaObject::invokeMethod(this, [this]() {
+            m_teardownPending = false;
+            std::vector<std::function<void()>> callbacks;
+            callbacks.swap(m_afterTeardown);
+            for (const std::function<void()> &cb : callbacks) {
+                cb();
+            }
+            emit teardownFinished();
+        }, Qt::QueuedConnection);
+    });
+}
+
 void QtTrustTunnelClient::setConfig(ag::TrustTunnelConfig config) {
     m_config = std::move(config);
     m_config->loglevel = m_logLevel;
     ag::Logger::set_log_level(m_logLevel);
     if (std::holds_alternative<ag::TrustTunnelConfig::TunListener>(m_config->listener)) {
         auto &tun = std::get<ag::TrustTunnelConfig::TunListener>(m_config->listener);
+        m_originalIncludedRoutes = tun.included_routes;
+        m_originalExcludedRoutes = tun.excluded_routes;
         tun.included_routes.insert(tun.included_routes.end(), m_extraIncludedRoutes.begin(), m_extraIncludedRoutes.end());
         tun.excluded_routes.insert(tun.excluded_routes.end(), m_extraExcludedRoutes.begin(), m_extraExcludedRoutes.end());
     }
     // Apply custom DNS overrides
+    m_originalDnsUpstreams = m_config->location.dns_upstreams;
     if (!m_customDns.empty()) {
         m_config->location.dns_upstreams = m_customDns;
     }
@@ -148,17 +264,32 @@ void QtTrustTunnelClient::setConfig(ag::TrustTunnelConfig config) {
 }
 
 bool QtTrustTunnelClient::loadConfigFromFile(const QString &path) {
-    const std::string configPath = path.toStdString();
-    toml::parse_result parsed = toml::parse_file(configPath);
-    if (!parsed) {
-        const std::string_view descrView = parsed.error().description();
-        const std::string descr{descrView};
+    if (!buildConfigFromFile(path, false)) {
+        return false;
+    }
+    setState(State::Disconnected);
+    return true;
+}
+
+bool QtTrustTunnelClient::buildConfigFromFile(const QString &path, bool rankEndpoints) {
+    // Served from memory unless the file changed; the copy is ours to reorder.
+    const std::shared_ptr<const ParsedConfig> parsed = parsedConfig(path);
+    if (!parsed->table) {
         setState(State::Error);
-        emit vpnError(QString("Failed parsing config: %1").arg(QString::fromStdString(descr)));
+        emit vpnError(QString("Failed parsing config: %1").arg(parsed->error));
         return false;
     }
+    toml::table table = *parsed->table;
+
+    if (rankEndpoints) {
+        rankEndpointAddresses(table);
+    }
+    // The core tries addresses in order, so outcomes are credited to the first one.
+    if (const std::optional<std::string_view> first = table["endpoint"]["addresses"][0].value<std::string_view>()) {
+        m_sessionEndpoint = QString::fromUtf8(first->data(), static_cast<int>(first->size())).trimmed();
+    }
 
-    auto config = ag::TrustTunnelConfig::build_config(parsed.table());
+    auto config = ag::TrustTunnelConfig::build_config(table);
     if (!config.has_value()) {
         setState(State::Error);
         emit vpnError(QStringLiteral("Invalid TrustTunnel config structure"));
@@ -167,17 +298,88 @@ bool QtTrustTunnelClient::loadConfigFromFile(const QString &path) {
 
     m_lastConfigPath = path;
     setConfig(std::move(*config));
-    setState(State::Disconnected);
     return true;
 }
 
+void QtTrustTunnelClient::rankEndpointAddresses(toml::table &table) {
+    toml::array *addrs = table["endpoint"]["addresses"].as_array();
+    if (!addrs || addrs->empty() || (addrs->size() < 2 && !m_standbyCheck)) {
+        return;
+    }
+    QStringList addresses;
+    for (const toml::node &n : *addrs) {
+        const std::optional<std::string_view> sv = n.value<std::string_view>();
+        if (!sv) {
+            return; // unexpected layout, leave it to build_config()
+        }
+        addresses.push_back(QString::fromUtf8(sv->data(), static_cast<int>(sv->size())));
+    }
+
+    // History alone still reorders the list when probing is off: endpoints
+    // that fail often sink behind the others.
+    std::vector<EndpointProbeResult> results;
+    if (m_probeEndpoints || m_standbyCheck) {
+        emit connectProgress(tr("Selecting fastest endpoint..."));
+        EndpointProber::Options options;
+        options.tls = m_probeTls || m_standbyCheck;
+        if (const std::optional<std::string_view> host = table["endpoint"]["hostname"].value<std::string_view>()) {
+            options.tlsServerName = QString::fromUtf8(host->data(), static_cast<int>(host->size()));
+        }
+        results = EndpointProber::probe(addresses, options);
+        const bool anyReachable = std::any_of(results.begin(), results.end(),
+                [](const EndpointProbeResult &r) { return r.reachable; });
+        m_standbyReachable = anyReachable;
+        for (const EndpointProbeResult &r : results) {
+            if (r.reachable) {
+                emit connectProgress(tr("Endpoint %1: %2 ms").arg(r.address.trimmed()).arg(r.rttMs));
+                m_endpointHealth.recordProbe(r.address, true, r.rttMs);
+            } else if (r.error != QLatin1String("not attempted")
+                    && (!anyReachable || r.error != QLatin1String("timed out"))) {
+                // Attempts cut short by the grace window say nothing about the endpoint.
+                m_endpointHealth.recordProbe(r.address, false, -1);
+            }
+        }
+    }
+    // Endpoints whose circuit breaker is open go last, behind everything
+    // health history would otherwise prefer.
+    std::vector<std::string> ranked;
+    for (const QString &a : m_endpointHealth.rank(addresses, results)) {
+        ranked.push_back(a.toStdString());
+    }
+    ranked = m_reconnectPolicy.order(ranked, steadyNowMs());
+    if (std::equal(ranked.begin(), ranked.end(), addresses.begin(), addresses.end(),
+                [](const std::string &r, const QString &a) { return r == a.toStdString(); })) {
+        return;
+    }
+    toml::array reordered;
+    for (const std::string &a : ranked) {
+        reordered.push_back(a);
+    }
+    *addrs = std::move(reordered);
+}
+
+void QtTrustTunnelClient::setEndpointProbing(bool enabled, bool tls) {
+    m_probeEndpoints = enabled;
+    m_probeTls = tls;
+}
+
+void QtTrustTunnelClient::setMakeBeforeBreak(bool enabled) {
+    m_makeBeforeBreak = enabled;
+}
+
 void QtTrustTunnelClient::setAutoReconnectEnabled(bool enabled) {
     m_autoReconnect = enabled;
 }
 
 void QtTrustTunnelClient::setReconnectBoundsMs(int initialDelayMs, int maxDelayMs) {
-    m_reconnectDelayMs = std::max(250, initialDelayMs);
-    m_reconnectMaxMs = std::max(m_reconnectDelayMs, maxDelayMs);
+    ReconnectPolicy::Options options = m_reconnectPolicy.options();
+    options.baseDelayMs = initialDelayMs;
+    options.maxDelayMs = maxDelayMs;
+    m_reconnectPolicy.setOptions(options);
+}
+
+void QtTrustTunnelClient::setReconnectPolicy(const ReconnectPolicy::Options &options) {
+    m_reconnectPolicy.setOptions(options);
 }
 
 void QtTrustTunnelClient::connectVpn() {
@@ -196,41 +398,25 @@ void QtTrustTunnelClient::connectVpn() {
         return;
     }
 #endif
+    if (m_teardownPending) {
+        // The previous session is still being released; starting now would
+        // race it for the TUN device and system DNS. Connect once it's gone.
+        m_afterTeardown.push_back([this]() { connectVpn(); });
+        return;
+    }
     m_stopRequested = false;
     m_reconnectTimer.stop();
+    m_fdMonitor.resetTrend();
     m_fdWatchdogTimer.start(); // start fd health monitoring
     setState(State::Connecting);
     doConnectAttemptInThread();
 }
 
 void QtTrustTunnelClient::doConnectAttemptInThread() {
-    // If thread is already running, wait for it to finish
-    if (m_connectThread.isRunning()) {
-        m_connectThread.quit();
-        m_connectThread.wait();
-    }
-
-    // BUG FIX: Disconnect any previous QThread::started connections that
-    // accumulated from earlier calls to this function.  Without this, every
-    // reconnect adds one more connection and on the N-th reconnect the lambda
-    // fires N times simultaneously, causing parallel doConnectAttempt() calls
-    // and a data race / crash on m_client.
-    disconnect(&m_connectThread, &QThread::started, nullptr, nullptr);
-
-    // BUG FIX: Use `worker` (not `this`) as the receiver context object so
-    // that Qt routes the lambda to m_connectThread instead of the main thread.
-    // With `this` as the context, Qt picks Qt::QueuedConnection across threads
-    // and posts the lambda to the main thread's event loop — doConnectAttempt()
-    // would then block the entire UI.
-    auto *worker = new QObject();
-    worker->moveToThread(&m_connectThread);
-    connect(&m_connectThread, &QThread::started, worker, [this, worker]() {
-        doConnectAttempt();
-        worker->deleteLater();
-        m_connectThread.quit();
-    });
-
-    m_connectThread.start();
+    // Runs after any queued teardown; a second request while one is already
+    // queued is coalesced, since the queued attempt reads the current config
+    // and rules when it starts.
+    m_executor.post(VpnCommandExecutor::Command::Connect, [this]() { doConnectAttempt(); });
 }
 
 void QtTrustTunnelClient::doConnectAttempt() {
@@ -250,6 +436,31 @@ void QtTrustTunnelClient::doConnectAttempt() {
         // instance via vpn_open() and overwrites the pointer, leaking the
         // previous session and all its resources.
         if (isReconnect) {
+            if (m_makeBeforeBreak && !m_lastConfigPath.isEmpty()) {
+                // Parse, rank and handshake-check the replacement while the
+                // old session still carries traffic, so the outage shrinks to
+                // the core's own teardown and connect.
+                emit connectProgress(tr("Preparing standby session..."));
+                const QString runningEndpoint = m_sessionEndpoint;
+                m_standbyReady = prepareStandby();
+                if (!m_standbyReady && m_keepOldSession) {
+                    m_keepOldSession = false;
+                    m_config.reset();
+                    m_sessionEndpoint = runningEndpoint;
+                    setState(State::Connected);
+                    emit vpnError(tr("No endpoint answered the standby handshake; keeping the current session"));
+                    return;
+                }
+            }
+            if (m_keepOldSession) {
+                // The kept session is replaced after all. Its end is recorded on
+                // the GUI thread, which owns m_sessionStart, ahead of the new
+                // session's state changes.
+                QMetaObject::invokeMethod(this, [this, endpoint = m_keptSessionEndpoint, reason = m_keptSessionReason]() {
+                    recordKeptSessionEnd(endpoint, reason);
+                }, Qt::QueuedConnection);
+            }
+            m_keepOldSession = false;
             emit connectProgress(tr("Disconnecting previous session..."));
             teardownClient();  // Full cleanup including networkMonitor
         }
@@ -258,9 +469,12 @@ void QtTrustTunnelClient::doConnectAttempt() {
             // TrustTunnelConfig is move-only (contains unique_ptr), so we
             // cannot copy it.  If m_config was already consumed by a previous
             // client session, reload it from the saved file path.
-            if (!m_config.has_value()) {
+            // Rebuilding from the file is also how endpoint.addresses gets
+            // re-ranked by current latency and endpoint history before every session.
+            const bool rank = !m_lastConfigPath.isEmpty() && !m_standbyReady;
+            if (!m_config.has_value() || rank) {
                 if (!m_lastConfigPath.isEmpty()) {
-                    if (!loadConfigFromFile(m_lastConfigPath)) {
+                    if (!buildConfigFromFile(m_lastConfigPath, rank)) {
                         // loadConfigFromFile already emits vpnError / sets Error state.
                         return;
                     }
@@ -272,8 +486,10 @@ void QtTrustTunnelClient::doConnectAttempt() {
             }
             emit connectProgress(tr("Initializing VPN core..."));
 
+            m_standbyReady = false;
             m_client = std::make_unique<ag::TrustTunnelClient>(std::move(*m_config), makeCallbacks());
             m_config.reset();
+            m_activeRules = RuleSet{m_extraIncludedRoutes, m_extraExcludedRoutes, m_customDns, m_extraExclusions};
 
             emit connectProgress(tr("Starting network monitor..."));
 
@@ -301,6 +517,7 @@ void QtTrustTunnelClient::doConnectAttempt() {
         }
 
         m_lastConnectAttempt = std::chrono::steady_clock::now();
+        m_attemptPending = true;
 
         emit connectProgress(tr("Establishing tunnel..."));
 
@@ -317,12 +534,13 @@ void QtTrustTunnelClient::doConnectAttempt() {
                 emit vpnError(QString("connect() failed: %1").arg(qErr));
                 return;
             }
-            scheduleReconnect(QString("connect() failed: %1").arg(qErr));
+            // The error carries no code we can act on; DISCONNECTED reports one if the core gets that far.
+            scheduleReconnect(QString("connect() failed: %1").arg(qErr), FailureKind::Other);
             return;
         }
     } catch (const std::exception &e) {
         teardownClient();
-        scheduleReconnect(QString::fromUtf8(e.what()));
+        scheduleReconnect(QString::fromUtf8(e.what()), FailureKind::Other);
     }
 }
 
@@ -332,23 +550,19 @@ void QtTrustTunnelClient::disconnectVpn() {
     m_fdWatchdogTimer.stop();
     m_networkWaitTimer.stop();
 
-    // Stop connect thread if running.  No timeout: teardownClient() below calls
-    // m_client.reset() and a running thread would still hold a pointer to it.
-    if (m_connectThread.isRunning()) {
-        m_connectThread.quit();
-        if (!m_connectThread.wait(15000)) {
-            qWarning("[disconnectVpn] connect thread did not exit in 15 s — forcing terminate");
-            m_connectThread.terminate();
-            m_connectThread.wait();
-        }
-    }
-
+    // A connect attempt in flight sees m_stopRequested and the teardown
+    // worker waits for it to return before releasing the client, so nothing
+    // here blocks the GUI thread.
     setState(State::Disconnecting);
-    teardownClient();
-
-    m_everConnected = false;
-    setState(State::Disconnected);
-    emit vpnDisconnected();
+    recordEndpointOutcome(QStringLiteral("user disconnect"), false);
+    teardownClientAsync([this]() {
+        if (!m_stopRequested) {
+            return; // a connect queued behind this teardown has already taken over
+        }
+        m_everConnected = false;
+        setState(State::Disconnected);
+        emit vpnDisconnected();
+    });
     // NOTE: m_stopRequested is intentionally left TRUE so that any stale
     // core state-change callbacks still queued (via Qt::QueuedConnection)
     // are silently discarded by handleCoreStateChanged(). The flag is
@@ -363,6 +577,14 @@ QtTrustTunnelClient::State QtTrustTunnelClient::state() const {
     return m_state;
 }
 
+TrafficCounters::Snapshot QtTrustTunnelClient::trafficSnapshot() const {
+    return m_traffic.snapshot();
+}
+
+void QtTrustTunnelClient::resetTrafficCounters() {
+    m_traffic.reset();
+}
+
 void QtTrustTunnelClient::setLogLevel(const QString &level) {
     m_logLevel = parse_log_level(level);
     ag::Logger::set_log_level(m_logLevel);
@@ -376,7 +598,11 @@ void QtTrustTunnelClient::setRoutingRules(const std::vector<std::string> &includ
     m_extraIncludedRoutes = includeRoutes;
     m_extraExcludedRoutes = excludeRoutes;
     if (m_config.has_value() && std::holds_alternative<ag::TrustTunnelConfig::TunListener>(m_config->listener)) {
+        // Restore the config file's own routes first so repeated calls replace
+        // our additions instead of stacking duplicates.
         auto &tun = std::get<ag::TrustTunnelConfig::TunListener>(m_config->listener);
+        tun.included_routes = m_originalIncludedRoutes;
+        tun.excluded_routes = m_originalExcludedRoutes;
         tun.included_routes.insert(tun.included_routes.end(), m_extraIncludedRoutes.begin(), m_extraIncludedRoutes.end());
         tun.excluded_routes.insert(tun.excluded_routes.end(), m_extraExcludedRoutes.begin(), m_extraExcludedRoutes.end());
     }
@@ -384,8 +610,8 @@ void QtTrustTunnelClient::setRoutingRules(const std::vector<std::string> &includ
 
 void QtTrustTunnelClient::setCustomDns(const std::vector<std::string> &dnsServers) {
     m_customDns = dnsServers;
-    if (m_config.has_value() && !m_customDns.empty()) {
-        m_config->location.dns_upstreams = m_customDns;
+    if (m_config.has_value()) {
+        m_config->location.dns_upstreams = m_customDns.empty() ? m_originalDnsUpstreams : m_customDns;
     }
 }
 
@@ -404,6 +630,62 @@ void QtTrustTunnelClient::setExtraExclusions(const std::vector<std::string> &exc
     }
 }
 
+QtTrustTunnelClient::RuleDelta QtTrustTunnelClient::diffRules(const RuleSet &from, const RuleSet &to) {
+    // Count entries present on one side only. Sorting copies keeps this
+    // O(n log n) for routing lists with tens of thousands of prefixes.
+    auto countDiff = [](std::vector<std::string> a, std::vector<std::string> b, size_t &added, size_t &removed) {
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        size_t i = 0;
+        size_t j = 0;
+        while (i < a.size() || j < b.size()) {
+            if (j == b.size() || (i < a.size() && a[i] < b[j])) {
+                ++removed;
+                ++i;
+            } else if (i == a.size() || b[j] < a[i]) {
+                ++added;
+                ++j;
+            } else {
+                ++i;
+                ++j;
+            }
+        }
+    };
+    RuleDelta delta;
+    countDiff(from.includedRoutes, to.includedRoutes, delta.routesAdded, delta.routesRemoved);
+    countDiff(from.excludedRoutes, to.excludedRoutes, delta.routesAdded, delta.routesRemoved);
+    countDiff(from.exclusions, to.exclusions, delta.exclusionsAdded, delta.exclusionsRemoved);
+    delta.dnsChanged = from.dnsServers != to.dnsServers;
+    return delta;
+}
+
+QtTrustTunnelClient::RuleDelta QtTrustTunnelClient::applyRules(const RuleSet &rules) {
+    const bool live = m_client && m_state == State::Connected && !m_stopRequested;
+    RuleDelta delta = diffRules(live ? m_activeRules : RuleSet{m_extraIncludedRoutes, m_extraExcludedRoutes,
+                                                               m_customDns, m_extraExclusions},
+                                rules);
+    if (delta.isEmpty()) {
+        return delta;
+    }
+    setRoutingRules(rules.includedRoutes, rules.excludedRoutes);
+    setCustomDns(rules.dnsServers);
+    setExtraExclusions(rules.exclusions);
+    if (!live) {
+        // Idle or mid-reconnect: the next attempt reloads the config and picks these up.
+        return delta;
+    }
+    // The consumed config is rebuilt from m_lastConfigPath with the new extras
+    // in doConnectAttempt(); skip the Disconnected/Connecting round-trip the
+    // UI would otherwise see and go straight to Reconnecting.
+    m_config.reset();
+    m_reconnectTimer.stop();
+    emit connectProgress(tr("Applying routing changes..."));
+    setState(State::Reconnecting);
+    doConnectAttemptInThread();
+    delta.sessionRebuilt = true;
+    return delta;
+}
+
 ag::VpnCallbacks QtTrustTunnelClient::makeCallbacks() {
     ag::VpnCallbacks callbacks;
     callbacks.protect_handler = [](ag::SocketProtectEvent *event) {
@@ -444,46 +726,128 @@ ag::VpnCallbacks QtTrustTunnelClient::makeCallbacks() {
     };
     callbacks.state_changed_handler = [this](ag::VpnStateChangedEvent *event) {
         ag::VpnSessionState state = event ? event->state : ag::VPN_SS_DISCONNECTED;
-        QMetaObject::invokeMethod(this, [this, state]() { handleCoreStateChanged(state); }, Qt::QueuedConnection);
+        // The error is only set for DISCONNECTED; its text does not outlive the callback.
+        int errorCode = ag::VPN_EC_NOERROR;
+        QString errorText;
+        if (event && state == ag::VPN_SS_DISCONNECTED) {
+            errorCode = event->error.code;
+            errorText = QString::fromUtf8(event->error.text ? event->error.text : "");
+        }
+        QMetaObject::invokeMethod(this, [this, state, errorCode, errorText]() {
+            handleCoreStateChanged(state, errorCode, errorText);
+        }, Qt::QueuedConnection);
     };
+    // Traffic callbacks run on core threads at packet rate. They only bump
+    // sharded atomics; the UI polls trafficSnapshot() on its own timer, so no
+    // Qt event or string is created per packet.
     callbacks.client_output_handler = [this](ag::VpnClientOutputEvent *event) {
+        if (!event) {
+            return;
+        }
         size_t bytes = 0;
-        if (event) {
-            for (size_t i = 0; i < event->packet.chunks_num; ++i) {
-                bytes += event->packet.chunks[i].iov_len;
-            }
+        for (size_t i = 0; i < event->packet.chunks_num; ++i) {
+            bytes += event->packet.chunks[i].iov_len;
         }
-        QMetaObject::invokeMethod(this, [this, bytes]() { emit clientOutput(QString::number(bytes)); },
-                Qt::QueuedConnection);
+        m_traffic.addRx(bytes, 1);
     };
     callbacks.tunnel_stats_handler = [this](ag::VpnTunnelConnectionStatsEvent *event) {
         if (event) {
-            quint64 up = event->upload;
-            quint64 down = event->download;
-            QMetaObject::invokeMethod(this, [this, up, down]() { emit tunnelStats(up, down); },
-                    Qt::QueuedConnection);
+            m_traffic.addRx(event->download);
+            m_traffic.addTx(event->upload);
+            m_connectionEvents.pushStats(event->id, event->upload, event->download);
         }
     };
+    // Fired for every TCP/UDP flow. Write a compact record into the bounded
+    // ring instead of building a QString and posting an event per flow.
     callbacks.connection_info_handler = [this](ag::VpnConnectionInfoEvent *event) {
-        QString line = QStringLiteral("connection info");
-        if (event) {
-            QString action;
-            switch (event->action) {
-            case ag::VPN_FCA_BYPASS: action = QStringLiteral("bypass"); break;
-            case ag::VPN_FCA_TUNNEL: action = QStringLiteral("tunnel"); break;
-            case ag::VPN_FCA_REJECT: action = QStringLiteral("reject"); break;
-            default: action = QStringLiteral("unknown"); break;
-            }
-            const QString domain = event->domain ? QString::fromUtf8(event->domain) : QStringLiteral("-");
-            line = QStringLiteral("%1 %2").arg(action, domain);
+        if (!event) {
+            return;
+        }
+        FlowAction action = FlowAction::Unknown;
+        switch (event->action) {
+        case ag::VPN_FCA_BYPASS: action = FlowAction::Bypass; break;
+        case ag::VPN_FCA_TUNNEL: action = FlowAction::Tunnel; break;
+        case ag::VPN_FCA_REJECT: action = FlowAction::Reject; break;
+        default: break;
         }
-        QMetaObject::invokeMethod(this, [this, line]() { emit connectionInfo(line); }, Qt::QueuedConnection);
+        m_connectionEvents.push(event->id, action, event->domain);
     };
     return callbacks;
 }
 
-void QtTrustTunnelClient::scheduleReconnect(const QString &reason) {
+void QtTrustTunnelClient::recordEndpointOutcome(const QString &reason, bool endpointFault) {
+    if (m_sessionEndpoint.isEmpty()) {
+        return;
+    }
+    if (m_sessionStart != std::chrono::steady_clock::time_point{}) {
+        const auto lifetime = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::steady_clock::now() - m_sessionStart).count();
+        m_endpointHealth.recordSessionEnd(m_sessionEndpoint, lifetime, reason, endpointFault);
+    } else if (m_attemptPending && endpointFault) {
+        m_endpointHealth.recordFailure(m_sessionEndpoint, reason);
+    }
+    m_sessionStart = {};
+    m_attemptPending = false;
+}
+
+void QtTrustTunnelClient::recordKeptSessionEnd(const QString &endpoint, const QString &reason) {
+    // Unlike recordEndpointOutcome(), leaves m_attemptPending alone: it
+    // already belongs to the replacement's connect().
+    if (!endpoint.isEmpty() && m_sessionStart != std::chrono::steady_clock::time_point{}) {
+        const auto lifetime = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::steady_clock::now() - m_sessionStart).count();
+        m_endpointHealth.recordSessionEnd(endpoint, lifetime, reason, false);
+    }
+    m_sessionStart = {};
+}
+
+bool QtTrustTunnelClient::prepareStandby() {
+    m_standbyCheck = true;
+    m_standbyReachable = false;
+    const bool built = buildConfigFromFile(m_lastConfigPath, true);
+    m_standbyCheck = false;
+    return built && m_standbyReachable;
+}
+
+void QtTrustTunnelClient::plannedReconnect(const QString &reason, bool oldSessionUsable) {
+    // Fall back to break-before-make when the feature is off, a reconnect is
+    // already under way, or the last attempt was recent enough that backoff
+    // should apply.
+    if (m_teardownPending || (m_makeBeforeBreak && m_executor.isBusy())) {
+        return; // the session is already being replaced
+    }
+    const auto sinceLastAttempt = std::chrono::steady_clock::now() - m_lastConnectAttempt;
+    if (!m_makeBeforeBreak || m_lastConfigPath.isEmpty() || !m_client || m_reconnectTimer.isActive()
+            || sinceLastAttempt < std::chrono::seconds(10)) {
+        setState(State::Reconnecting);
+        // Planned reconnects are local or core-initiated, so they must not
+        // count against the endpoint's breaker or the retry limit.
+        teardownClientAsync([this, reason, oldSessionUsable]() {
+            recordEndpointOutcome(reason, !oldSessionUsable);
+            if (!m_stopRequested) {
+                scheduleReconnect(reason, FailureKind::Network);
+            }
+        });
+        return;
+    }
+    if (oldSessionUsable) {
+        // The old session stays up if the standby fails, so its end is only
+        // recorded once doConnectAttempt() actually tears it down.
+        m_keptSessionEndpoint = m_sessionEndpoint;
+        m_keptSessionReason = reason;
+    } else {
+        recordEndpointOutcome(reason, true);
+    }
+    m_keepOldSession = oldSessionUsable;
+    emit vpnError(reason);
+    setState(State::Reconnecting);
+    doConnectAttemptInThread(); // sees m_client and prepares the standby before tearing it down
+}
+
+void QtTrustTunnelClient::scheduleReconnect(const QString &reason, FailureKind kind) {
     const QString message = reason.isEmpty() ? QStringLiteral("connect() failed") : reason;
+    // No-op if the caller already recorded this outcome (e.g. as not the endpoint's fault).
+    recordEndpointOutcome(message, true);
     if (m_stopRequested || !m_autoReconnect) {
         setState(State::Error);
         emit vpnError(message);
@@ -496,24 +860,21 @@ void QtTrustTunnelClient::scheduleReconnect(const QString &reason) {
         return;
     }
 
-    // If the connection was very short-lived (<10s), the issue is likely
-    // persistent — increase the backoff faster to avoid a rapid reconnect loop.
-    auto now = std::chrono::steady_clock::now();
-    auto sinceLastAttempt = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastConnectAttempt).count();
-    if (m_lastConnectAttempt != std::chrono::steady_clock::time_point{} && sinceLastAttempt < 10000) {
-        m_reconnectDelayMs = std::min(m_reconnectDelayMs * 2, m_reconnectMaxMs);
+    const int64_t sinceLastAttempt = m_lastConnectAttempt == std::chrono::steady_clock::time_point{}
+            ? -1
+            : std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - m_lastConnectAttempt).count();
+    const ReconnectPolicy::Decision decision =
+            m_reconnectPolicy.onFailure(m_sessionEndpoint.toStdString(), kind, steadyNowMs(), sinceLastAttempt);
+    if (!decision.retry) {
+        setState(State::Error);
+        emit vpnError(tr("%1 (giving up after %2 attempts)").arg(message).arg(m_reconnectPolicy.consecutiveFailures()));
+        return;
     }
 
-    // Add jitter (±20%) to avoid thundering-herd reconnects.
-    int jitter = static_cast<int>(m_reconnectDelayMs * 0.2);
-    int jitteredDelay = m_reconnectDelayMs
-            + (jitter > 0 ? QRandomGenerator::global()->bounded(-jitter, jitter + 1) : 0);
-    jitteredDelay = std::max(250, jitteredDelay);
-
     setState(State::Reconnecting);
     emit vpnError(message);
-    m_reconnectTimer.start(jitteredDelay);
-    m_reconnectDelayMs = std::min(m_reconnectDelayMs * 2, m_reconnectMaxMs);
+    m_reconnectTimer.start(decision.delayMs);
 }
 
 void QtTrustTunnelClient::setState(State s) {
@@ -524,17 +885,27 @@ void QtTrustTunnelClient::setState(State s) {
     emit stateChanged(m_state);
 }
 
-void QtTrustTunnelClient::handleCoreStateChanged(ag::VpnSessionState state) {
+void QtTrustTunnelClient::handleCoreStateChanged(ag::VpnSessionState state, int errorCode,
+                                                 const QString &errorText) {
     if (m_stopRequested) {
         return;
     }
 
     switch (state) {
     case ag::VPN_SS_CONNECTED:
-        m_reconnectDelayMs = 1000;
+        m_reconnectPolicy.onSuccess(m_sessionEndpoint.toStdString());
         m_reconnectTimer.stop();
         m_networkWaitTimer.stop(); // no longer waiting for network
         m_everConnected = true;
+        if (m_attemptPending && !m_sessionEndpoint.isEmpty()) {
+            const auto connectMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - m_lastConnectAttempt).count();
+            m_endpointHealth.recordConnected(m_sessionEndpoint, connectMs);
+        }
+        m_attemptPending = false;
+        if (m_sessionStart == std::chrono::steady_clock::time_point{}) {
+            m_sessionStart = std::chrono::steady_clock::now();
+        }
         setState(State::Connected);
         emit vpnConnected();
         break;
@@ -549,8 +920,7 @@ void QtTrustTunnelClient::handleCoreStateChanged(ag::VpnSessionState state) {
         // the Qt layer to avoid exhausting file descriptors.
         m_networkWaitTimer.stop();
         if (!m_stopRequested && m_autoReconnect) {
-            teardownClient();
-            scheduleReconnect(QStringLiteral("recovery: full reconnect to avoid fd leak"));
+            plannedReconnect(QStringLiteral("recovery: full reconnect to avoid fd leak"), false);
         } else {
             setState(m_everConnected ? State::Reconnecting : State::Connecting);
         }
@@ -560,8 +930,7 @@ void QtTrustTunnelClient::handleCoreStateChanged(ag::VpnSessionState state) {
         // do a clean reconnect from our side.
         m_networkWaitTimer.stop();
         if (!m_stopRequested && m_autoReconnect) {
-            teardownClient();
-            scheduleReconnect(QStringLiteral("waiting recovery: full reconnect to avoid fd leak"));
+            plannedReconnect(QStringLiteral("waiting recovery: full reconnect to avoid fd leak"), false);
         } else {
             setState(m_everConnected ? State::Reconnecting : State::Connecting);
         }
@@ -570,11 +939,16 @@ void QtTrustTunnelClient::handleCoreStateChanged(ag::VpnSessionState state) {
         // Network connectivity lost (internet disconnect, sleep mode, etc.).
         // Show a distinct state so the user knows the issue is local.
         // Start a watchdog: if the core does not self-recover within 30 s,
-        // we force a full teardown + reconnect.  This handles the common
-        // sleep/wake scenario where the core gets stuck after waking up.
+        // we force a full teardown + reconnect.  Sleep/wake is handled
+        // directly by m_suspendMonitor.
         setState(State::WaitingForNetwork);
         if (!m_stopRequested && m_autoReconnect) {
             m_networkWaitTimer.start();
+            if (m_netlinkMonitor.defaultRouteAvailable()) {
+                // The route never went away (or came back before the core
+                // noticed): no netlink event will follow, so don't wait 30 s.
+                m_routeBackTimer.start(kRouteStillUpGraceMs);
+            }
         }
         break;
     case ag::VPN_SS_DISCONNECTED:
@@ -584,71 +958,70 @@ void QtTrustTunnelClient::handleCoreStateChanged(ag::VpnSessionState state) {
         // client and reload the config.
         m_networkWaitTimer.stop();
         if (!m_stopRequested) {
-            scheduleReconnect(QStringLiteral("core disconnected"));
+            scheduleReconnect(errorText.isEmpty() ? QStringLiteral("core disconnected")
+                                                  : QStringLiteral("core disconnected: %1").arg(errorText),
+                    failureKindFor(errorCode));
         }
         break;
     default:
         break;
     }
 }
-#ifndef _WIN32
-#include <unistd.h>
-#include <sys/resource.h>
-#include <dirent.h>
-#endif
-
-int QtTrustTunnelClient::countOpenFds() {
-#if defined(__APPLE__) || defined(__linux__)
-    int count = 0;
-    DIR *dir = opendir("/dev/fd");
-    if (!dir) {
-        // Fallback for Linux: /proc/self/fd
-        dir = opendir("/proc/self/fd");
-    }
-    if (dir) {
-        while (readdir(dir) != nullptr) {
-            ++count;
-        }
-        closedir(dir);
-        count -= 2; // subtract "." and ".."
-    }
-    return count;
-#else
-    return -1; // not supported on Windows
-#endif
-}
-
-int QtTrustTunnelClient::getFdLimit() {
-#ifndef _WIN32
-    struct rlimit rl{};
-    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
-        return static_cast<int>(rl.rlim_cur);
-    }
-#endif
-    return -1;
-}
-
 void QtTrustTunnelClient::checkFdHealth() {
     if (m_state != State::Connected && m_state != State::Reconnecting) {
         return;
     }
-    const int openFds = countOpenFds();
-    const int fdLimit = getFdLimit();
-    if (openFds < 0 || fdLimit < 0) {
+    const FdMonitor::Sample sample = m_fdMonitor.sample();
+    if (sample.open < 0 || sample.limit <= 0) {
         return; // platform doesn't support fd counting
     }
 
-    // If we're using more than 70% of the fd limit, force a clean reconnect
-    // to release leaked sockets from the VPN core.
-    const double usage = static_cast<double>(openFds) / static_cast<double>(fdLimit);
-    if (usage > 0.70) {
+    // Past 70% of the limit, force a clean reconnect to release leaked
+    // sockets from the VPN core. Sustained growth that would reach the limit
+    // within the horizon triggers it earlier, once usage is clearly above
+    // what a normal session needs.
+    const double usage = sample.usage();
+    const bool sustainedGrowth = sample.growingSamples >= kFdMinGrowingSamples;
+    const bool critical = usage > 0.70;
+    const bool predicted = sustainedGrowth && usage > 0.25 && sample.secsToExhaustion >= 0
+            && sample.secsToExhaustion < kFdExhaustionHorizonSecs;
+
+    // The per-kind breakdown walks every fd, so it's only taken while the
+    // count looks suspicious, at most once a minute, and on the classifier
+    // thread: with thousands of fds the walk takes long enough to stall the UI.
+    const bool suspicious = sustainedGrowth || usage > 0.50;
+    if (suspicious && !m_fdClassifyPending
+            && (!m_fdClassifyClock.isValid() || m_fdClassifyClock.hasExpired(kFdClassifyIntervalMs))) {
+        m_fdClassifyPending = true;
+        m_fdClassifyClock.start();
+        m_fdClassifier.start([this, sample]() {
+            FdMonitor::Breakdown breakdown = m_fdMonitor.classify(); // reads only /proc, no monitor state
+            QMetaObject::invokeMethod(this, [this, sample, breakdown = std::move(breakdown)]() {
+                m_fdClassifyPending = false;
+                qWarning("[fd watchdog] %d / %d fds, %+.1f/min: %s", sample.open, sample.limit,
+                        sample.growthPerMin, qUtf8Printable(breakdown.toString()));
+            }, Qt::QueuedConnection);
+        });
+    }
+    if (!critical && !predicted) {
+        return;
+    }
+
+    if (critical) {
         qWarning("[fd watchdog] Open fds: %d / %d (%.0f%%) — forcing clean reconnect",
-                openFds, fdLimit, usage * 100.0);
-        emit vpnError(QString("fd watchdog: %1/%2 fds used, reconnecting...")
-                .arg(openFds).arg(fdLimit));
-        teardownClient();
-        if (!m_stopRequested && m_autoReconnect) {
-            scheduleReconnect(QStringLiteral("fd watchdog: too many open files, clean reconnect"));
-        }
+                sample.open, sample.limit, usage * 100.0);
+    } else {
+        qWarning("[fd watchdog] Open fds: %d / %d, growing %.1f/min, limit in ~%.0f s — reconnecting early",
+                sample.open, sample.limit, sample.growthPerMin, sample.secsToExhaustion);
+    }
+    emit vpnError(QString("fd watchdog: %1/%2 fds used, reconnecting...")
+            .arg(sample.open).arg(sample.limit));
+    m_fdMonitor.resetTrend(); // the replacement session starts from a clean slate
+    if (!m_stopRequested && m_autoReconnect) {
+        // The session itself still works, so this is the case make-before-break is for.
+        plannedReconnect(QStringLiteral("fd watchdog: too many open files, clean reconnect"), true);
+    } else {
+        recordEndpointOutcome(QStringLiteral("fd watchdog"), false);
+        teardownClientAsync(nullptr);
     }
 }
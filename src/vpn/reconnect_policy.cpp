@@ -0,0 +1,163 @@
+#include "reconnect_policy.h"
+
+#include <algorithm>
+#include <limits>
+
+const char *failureKindName(FailureKind kind) {
+    switch (kind) {
+    case FailureKind::Auth: return "auth";
+    case FailureKind::Tls: return "tls";
+    case FailureKind::Timeout: return "timeout";
+    case FailureKind::Network: return "network";
+    case FailureKind::Other: break;
+    }
+    return "other";
+}
+
+ReconnectPolicy::ReconnectPolicy()
+    : ReconnectPolicy(Options{}, std::random_device{}()) {
+}
+
+ReconnectPolicy::ReconnectPolicy(const Options &options, uint64_t seed)
+    : m_rng(seed) {
+    setOptions(options);
+}
+
+void ReconnectPolicy::setOptions(const Options &options) {
+    std::lock_guard lock(m_mutex);
+    m_options = options;
+    m_options.baseDelayMs = std::max(250, m_options.baseDelayMs);
+    m_options.maxDelayMs = std::max(m_options.baseDelayMs, m_options.maxDelayMs);
+}
+
+ReconnectPolicy::Options ReconnectPolicy::options() const {
+    std::lock_guard lock(m_mutex);
+    return m_options;
+}
+
+int ReconnectPolicy::nextDelayLocked(FailureKind kind, int64_t sinceAttemptMs) {
+    const int base = m_options.baseDelayMs;
+    const int cap = m_options.maxDelayMs;
+    if (kind == FailureKind::Network) {
+        return base;
+    }
+    if (kind == FailureKind::Auth) {
+        m_delayMs = cap;
+        return cap;
+    }
+    if (m_options.jitter == Jitter::Decorrelated) {
+        const int prev = std::max(base, m_delayMs);
+        const int hi = static_cast<int>(std::min<int64_t>(cap, static_cast<int64_t>(prev) * 3));
+        m_delayMs = std::uniform_int_distribution<int>(base, std::max(base, hi))(m_rng);
+        return m_delayMs;
+    }
+    // Proportional: exponential backoff with ±20% jitter. A session that died
+    // within 10 s of being attempted points at a persistent problem, so the
+    // delay escalates twice as fast.
+    int delay = m_delayMs == 0 ? base : m_delayMs;
+    if (sinceAttemptMs >= 0 && sinceAttemptMs < 10000) {
+        delay = std::min(delay * 2, cap);
+    }
+    const int jitter = static_cast<int>(delay * 0.2);
+    int jittered = delay + (jitter > 0 ? std::uniform_int_distribution<int>(-jitter, jitter)(m_rng) : 0);
+    jittered = std::max(250, jittered);
+    m_delayMs = std::min(delay * 2, cap);
+    return jittered;
+}
+
+ReconnectPolicy::Decision ReconnectPolicy::onFailure(const std::string &endpoint, FailureKind kind, int64_t nowMs,
+                                                     int64_t sinceAttemptMs) {
+    std::lock_guard lock(m_mutex);
+    Decision d;
+    if (kind != FailureKind::Network) {
+        ++m_failures;
+        if (!endpoint.empty()) {
+            Breaker &b = m_breakers[endpoint];
+            ++b.consecutiveFailures;
+            const BreakerState before = stateLocked(b, nowMs);
+            if (before == BreakerState::HalfOpen || kind == FailureKind::Auth
+                    || b.consecutiveFailures >= m_options.breakerThreshold) {
+                const int shift = std::min(b.trips, 10);
+                const int64_t cooldown = std::min<int64_t>(m_options.breakerMaxCooldownMs,
+                        static_cast<int64_t>(m_options.breakerCooldownMs) << shift);
+                b.openUntilMs = nowMs + cooldown;
+                ++b.trips;
+            }
+        }
+    }
+    if (m_options.maxRetries > 0 && m_failures >= m_options.maxRetries) {
+        d.retry = false;
+        return d;
+    }
+    d.delayMs = nextDelayLocked(kind, sinceAttemptMs);
+
+    // Nothing worth trying before the earliest breaker goes half-open.
+    int64_t earliest = std::numeric_limits<int64_t>::max();
+    const auto consider = [&](const std::string &e) {
+        const auto it = m_breakers.find(e);
+        if (it == m_breakers.end() || stateLocked(it->second, nowMs) != BreakerState::Open) {
+            earliest = nowMs;
+        } else {
+            earliest = std::min(earliest, it->second.openUntilMs);
+        }
+    };
+    if (!m_candidates.empty()) {
+        std::for_each(m_candidates.begin(), m_candidates.end(), consider);
+    } else {
+        for (const auto &[name, b] : m_breakers) {
+            consider(name);
+        }
+    }
+    if (earliest != std::numeric_limits<int64_t>::max()) {
+        d.delayMs = static_cast<int>(std::max<int64_t>(d.delayMs, earliest - nowMs));
+    }
+    return d;
+}
+
+void ReconnectPolicy::onSuccess(const std::string &endpoint) {
+    std::lock_guard lock(m_mutex);
+    m_delayMs = 0;
+    m_failures = 0;
+    if (!endpoint.empty()) {
+        m_breakers[endpoint] = Breaker{};
+    }
+}
+
+void ReconnectPolicy::resetBackoff() {
+    std::lock_guard lock(m_mutex);
+    m_delayMs = 0;
+    m_failures = 0;
+}
+
+ReconnectPolicy::BreakerState ReconnectPolicy::stateLocked(const Breaker &b, int64_t nowMs) const {
+    if (b.openUntilMs == 0) {
+        return BreakerState::Closed;
+    }
+    return nowMs < b.openUntilMs ? BreakerState::Open : BreakerState::HalfOpen;
+}
+
+ReconnectPolicy::BreakerState ReconnectPolicy::breakerState(const std::string &endpoint, int64_t nowMs) const {
+    std::lock_guard lock(m_mutex);
+    const auto it = m_breakers.find(endpoint);
+    return it == m_breakers.end() ? BreakerState::Closed : stateLocked(it->second, nowMs);
+}
+
+std::vector<std::string> ReconnectPolicy::order(const std::vector<std::string> &endpoints, int64_t nowMs) {
+    std::lock_guard lock(m_mutex);
+    m_candidates = endpoints;
+    const auto rank = [&](const std::string &e) {
+        const auto it = m_breakers.find(e);
+        return it == m_breakers.end() ? BreakerState::Closed : stateLocked(it->second, nowMs);
+    };
+    static constexpr int kOrder[] = {0, 2, 1}; // Closed, Open, HalfOpen
+    std::vector<std::string> out = endpoints;
+    std::stable_sort(out.begin(), out.end(), [&](const std::string &a, const std::string &b) {
+        return kOrder[static_cast<int>(rank(a))] < kOrder[static_cast<int>(rank(b))];
+    });
+    return out;
+}
+
+int ReconnectPolicy::consecutiveFailures() const {
+    std::lock_guard lock(m_mutex);
+    return m_failures;
+}
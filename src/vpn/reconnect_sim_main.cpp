@@ -0,0 +1,247 @@
+// Offline replay of failure sequences against ReconnectPolicy, for tuning
+// backoff and circuit-breaker settings without shipping experiments.
+//
+//   trusttunnel-qt-reconnect-sim [options] [scenario-file...]
+//
+// A scenario file has one outage per line: "<endpoint> <kind> <from_s> <to_s>",
+// meaning attempts on <endpoint> fail with <kind> (auth|tls|timeout|network|other)
+// while from_s <= t < to_s. An endpoint of "*" fails every endpoint (a local
+// network outage). "endpoints a b c" sets the address list (default: a b),
+// "#" starts a comment. Without files, built-in scenarios are run.
+//
+// Each scenario is replayed with many seeds per jitter strategy; the report
+// lists time to recover (first success after the earliest outage began) and
+// the number of attempts it took.
+
+#include "reconnect_policy.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct SimOutage {
+    std::string endpoint;
+    FailureKind kind = FailureKind::Other;
+    int64_t fromMs = 0;
+    int64_t toMs = 0;
+};
+
+struct SimScenario {
+    std::string name;
+    std::vector<std::string> endpoints{"a", "b"};
+    std::vector<SimOutage> outages;
+};
+
+struct SimRun {
+    bool recovered = false;
+    int64_t recoverMs = 0;
+    int attempts = 0;
+};
+
+static constexpr int64_t kAttemptCostMs = 3000; // a failed connect isn't instant
+static constexpr int64_t kHorizonMs = 2 * 60 * 60 * 1000;
+
+static bool parseKind(const std::string &s, FailureKind &kind) {
+    for (FailureKind k : {FailureKind::Auth, FailureKind::Tls, FailureKind::Timeout, FailureKind::Network,
+                 FailureKind::Other}) {
+        if (s == failureKindName(k)) {
+            kind = k;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool loadScenario(const std::string &path, SimScenario &out) {
+    std::ifstream in(path);
+    if (!in) {
+        std::fprintf(stderr, "%s: cannot open\n", path.c_str());
+        return false;
+    }
+    out.name = path;
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        if (const size_t hash = line.find('#'); hash != std::string::npos) {
+            line.erase(hash);
+        }
+        std::istringstream fields(line);
+        std::string first;
+        if (!(fields >> first)) {
+            continue;
+        }
+        if (first == "endpoints") {
+            out.endpoints.clear();
+            for (std::string e; fields >> e;) {
+                out.endpoints.push_back(e);
+            }
+            continue;
+        }
+        SimOutage o;
+        std::string kind;
+        double from = 0;
+        double to = 0;
+        o.endpoint = first;
+        if (!(fields >> kind >> from >> to) || !parseKind(kind, o.kind) || to < from) {
+            std::fprintf(stderr, "%s:%d: expected \"<endpoint> <kind> <from_s> <to_s>\"\n", path.c_str(), lineNo);
+            return false;
+        }
+        o.fromMs = static_cast<int64_t>(from * 1000);
+        o.toMs = static_cast<int64_t>(to * 1000);
+        out.outages.push_back(o);
+    }
+    if (out.endpoints.empty() || out.outages.empty()) {
+        std::fprintf(stderr, "%s: no endpoints or no outages\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+static std::vector<SimScenario> builtinScenarios() {
+    std::vector<SimScenario> s(4);
+    s[0].name = "network flap (40 s)";
+    s[0].outages = {{"*", FailureKind::Network, 0, 40000}};
+    s[1].name = "primary down 10 min, secondary fine";
+    s[1].outages = {{"a", FailureKind::Timeout, 0, 600000}};
+    s[2].name = "both endpoints down 5 min";
+    s[2].outages = {{"a", FailureKind::Timeout, 0, 300000}, {"b", FailureKind::Tls, 0, 300000}};
+    s[3].name = "auth rejected 2 min (credential rotation)";
+    s[3].endpoints = {"a"};
+    s[3].outages = {{"a", FailureKind::Auth, 0, 120000}};
+    return s;
+}
+
+static const SimOutage *activeOutage(const SimScenario &sc, const std::string &endpoint, int64_t t) {
+    for (const SimOutage &o : sc.outages) {
+        if ((o.endpoint == "*" || o.endpoint == endpoint) && t >= o.fromMs && t < o.toMs) {
+            return &o;
+        }
+    }
+    return nullptr;
+}
+
+// The client builds each session from the policy-ordered address list; the
+// simulator charges each attempt to the first endpoint in that order.
+static SimRun replay(const SimScenario &sc, ReconnectPolicy::Options options, uint64_t seed) {
+    ReconnectPolicy policy(options, seed);
+    SimRun run;
+    int64_t start = kHorizonMs;
+    for (const SimOutage &o : sc.outages) {
+        start = std::min(start, o.fromMs);
+    }
+    int64_t t = start;
+    int64_t attemptStart = -1;
+    while (t < kHorizonMs) {
+        ++run.attempts;
+        const std::vector<std::string> order = policy.order(sc.endpoints, t);
+        const SimOutage *failure = activeOutage(sc, order.front(), t);
+        if (!failure) {
+            policy.onSuccess(order.front());
+            run.recovered = true;
+            run.recoverMs = t - start;
+            return run;
+        }
+        attemptStart = t;
+        t += kAttemptCostMs;
+        const ReconnectPolicy::Decision d = policy.onFailure(order.front(), failure->kind, t, t - attemptStart);
+        if (!d.retry) {
+            return run;
+        }
+        t += d.delayMs;
+    }
+    return run;
+}
+
+static int64_t percentile(std::vector<int64_t> v, double p) {
+    if (v.empty()) {
+        return 0;
+    }
+    std::sort(v.begin(), v.end());
+    return v[static_cast<size_t>(p * static_cast<double>(v.size() - 1))];
+}
+
+static void report(const SimScenario &sc, const ReconnectPolicy::Options &base, int seeds) {
+    std::printf("%s\n", sc.name.c_str());
+    for (ReconnectPolicy::Jitter jitter : {ReconnectPolicy::Jitter::Proportional, ReconnectPolicy::Jitter::Decorrelated}) {
+        ReconnectPolicy::Options options = base;
+        options.jitter = jitter;
+        std::vector<int64_t> recover;
+        std::vector<int64_t> attempts;
+        int gaveUp = 0;
+        for (int seed = 1; seed <= seeds; ++seed) {
+            const SimRun r = replay(sc, options, static_cast<uint64_t>(seed));
+            if (r.recovered) {
+                recover.push_back(r.recoverMs);
+            } else {
+                ++gaveUp;
+            }
+            attempts.push_back(r.attempts);
+        }
+        std::printf("  %-12s recover p50 %6.1f s  p90 %6.1f s  max %6.1f s  attempts p50 %3lld max %3lld",
+                jitter == ReconnectPolicy::Jitter::Proportional ? "proportional" : "decorrelated",
+                static_cast<double>(percentile(recover, 0.5)) / 1000, static_cast<double>(percentile(recover, 0.9)) / 1000,
+                static_cast<double>(percentile(recover, 1.0)) / 1000, static_cast<long long>(percentile(attempts, 0.5)),
+                static_cast<long long>(percentile(attempts, 1.0)));
+        if (gaveUp > 0) {
+            std::printf("  gave up %d/%d", gaveUp, seeds);
+        }
+        std::printf("\n");
+    }
+}
+
+static void usage() {
+    std::fprintf(stderr,
+            "usage: trusttunnel-qt-reconnect-sim [--seeds N] [--base-ms N] [--max-ms N] [--max-retries N]\n"
+            "                                    [--breaker-threshold N] [--breaker-cooldown-ms N] [scenario...]\n");
+}
+
+int main(int argc, char **argv) {
+    ReconnectPolicy::Options options;
+    int seeds = 1000;
+    std::vector<SimScenario> scenarios;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto intArg = [&](int &out) {
+            if (i + 1 >= argc) {
+                usage();
+                std::exit(2);
+            }
+            out = std::atoi(argv[++i]);
+        };
+        if (arg == "--seeds") {
+            intArg(seeds);
+        } else if (arg == "--base-ms") {
+            intArg(options.baseDelayMs);
+        } else if (arg == "--max-ms") {
+            intArg(options.maxDelayMs);
+        } else if (arg == "--max-retries") {
+            intArg(options.maxRetries);
+        } else if (arg == "--breaker-threshold") {
+            intArg(options.breakerThreshold);
+        } else if (arg == "--breaker-cooldown-ms") {
+            intArg(options.breakerCooldownMs);
+        } else if (arg.rfind("-", 0) == 0) {
+            usage();
+            return arg == "-h" || arg == "--help" ? 0 : 2;
+        } else {
+            SimScenario sc;
+            if (!loadScenario(arg, sc)) {
+                return 1;
+            }
+            scenarios.push_back(std::move(sc));
+        }
+    }
+    if (scenarios.empty()) {
+        scenarios = builtinScenarios();
+    }
+    seeds = std::max(1, seeds);
+    for (const SimScenario &sc : scenarios) {
+        report(sc, options, seeds);
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include "suspend_monitor.h"
+
+#include <chrono>
+
+#if defined(__linux__)
+#include <time.h>
+#elif defined(__APPLE__)
+#include <mach/mach_time.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+static constexpr int kPollIntervalMs = 5000;
+static constexpr qint64 kMinSuspendMs = 3000; // smaller gaps are scheduling noise
+
+#if defined(__linux__)
+static qint64 clockMs(clockid_t id) {
+    timespec ts{};
+    clock_gettime(id, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+#elif defined(__APPLE__)
+static qint64 machMs(uint64_t ticks) {
+    static const mach_timebase_info_data_t tb = []() {
+        mach_timebase_info_data_t info{};
+        mach_timebase_info(&info);
+        return info;
+    }();
+    return static_cast<qint64>(static_cast<double>(ticks) * tb.numer / tb.denom / 1e6);
+}
+#endif
+
+/// Milliseconds on a clock that does not advance while the system is suspended.
+static qint64 awakeMs() {
+#if defined(__linux__)
+    return clockMs(CLOCK_MONOTONIC);
+#elif defined(__APPLE__)
+    return machMs(mach_absolute_time());
+#elif defined(_WIN32)
+    ULONGLONG t = 0;
+    QueryUnbiasedInterruptTime(&t); // 100 ns units, excludes sleep
+    return static_cast<qint64>(t / 10000);
+#else
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/// Milliseconds on a clock that keeps counting through suspend.
+static qint64 elapsedMs() {
+#if defined(__linux__)
+    return clockMs(CLOCK_BOOTTIME);
+#elif defined(__APPLE__)
+    return machMs(mach_continuous_time());
+#elif defined(_WIN32)
+    return static_cast<qint64>(GetTickCount64()); // includes sleep
+#else
+    // No suspend-aware clock: wall time, which NTP steps can also move.
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+#endif
+}
+
+SuspendMonitor::SuspendMonitor(QObject *parent)
+    : QObject(parent) {
+    m_timer.setInterval(kPollIntervalMs);
+    m_timer.setTimerType(Qt::VeryCoarseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &SuspendMonitor::poll);
+}
+
+void SuspendMonitor::start() {
+    m_lastAwakeMs = awakeMs();
+    m_lastElapsedMs = elapsedMs();
+    m_timer.start();
+}
+
+void SuspendMonitor::stop() {
+    m_timer.stop();
+}
+
+void SuspendMonitor::poll() {
+    const qint64 awake = awakeMs();
+    const qint64 elapsed = elapsedMs();
+    const qint64 slept = (elapsed - m_lastElapsedMs) - (awake - m_lastAwakeMs);
+    m_lastAwakeMs = awake;
+    m_lastElapsedMs = elapsed;
+    if (slept >= kMinSuspendMs) {
+        emit resumed(slept);
+    }
+}
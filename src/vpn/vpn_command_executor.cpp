@@ -0,0 +1,83 @@
+#include "vpn_command_executor.h"
+
+#include <QThread>
+#include <algorithm>
+
+VpnCommandExecutor::VpnCommandExecutor() {
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName(QStringLiteral("VpnCommandExecutor"));
+    m_thread->start();
+}
+
+VpnCommandExecutor::~VpnCommandExecutor() {
+    shutdown();
+    delete m_thread;
+}
+
+bool VpnCommandExecutor::post(Command command, std::function<void()> job) {
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_stopping) {
+            return false;
+        }
+        const auto queued = [this](Command c) {
+            return std::any_of(m_queue.begin(), m_queue.end(), [c](const Pending &p) { return p.command == c; });
+        };
+        switch (command) {
+        case Command::Connect:
+            if (queued(Command::Connect)) {
+                return false;
+            }
+            break;
+        case Command::Teardown:
+            m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(),
+                                  [](const Pending &p) { return p.command == Command::Connect; }),
+                    m_queue.end());
+            if (queued(Command::Teardown)) {
+                return false;
+            }
+            break;
+        }
+        m_queue.push_back({command, std::move(job)});
+    }
+    m_wake.notify_one();
+    return true;
+}
+
+bool VpnCommandExecutor::isBusy() const {
+    std::lock_guard lock(m_mutex);
+    return m_running || !m_queue.empty();
+}
+
+bool VpnCommandExecutor::isWorkerThread() const {
+    return QThread::currentThread() == m_thread;
+}
+
+void VpnCommandExecutor::shutdown() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+        m_queue.clear();
+    }
+    m_wake.notify_one();
+    if (m_thread && !isWorkerThread()) {
+        m_thread->wait();
+    }
+}
+
+void VpnCommandExecutor::run() {
+    std::unique_lock lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+        if (m_stopping) {
+            return;
+        }
+        Pending next = std::move(m_queue.front());
+        m_queue.pop_front();
+        m_running = true;
+        lock.unlock();
+        next.job();
+        lock.lock();
+        m_running = false;
+    }
+}